@@ -13,10 +13,14 @@
 /***** INCLUDES *****/
 #include "board.h"
 #include <math.h>
+#include <stdlib.h>
 
 /***** FUNCTIONALITY *****/
-// This flag is required to prevent stalemate loops
-static volatile int stalemate_check_flag = 0;
+/*
+ * The rules core keeps no state outside of the boards it is given: functions taking
+ * const Board_t * only read, functions taking Board_t * only write that board. Any number
+ * of threads may use it at once as long as no two of them write the same board.
+ */
 
 /** @fn void Board_init(Board_t *board)
  * @brief This gets called to initialize the board
@@ -36,6 +40,9 @@ void Board_init(Board_t *board) {
  * @returns none
  */
 void Board_init_default(Board_t *board) {
+    //No accumulator until one is attached
+    board->nnue = NULL;
+
     //White pieces
     board CB_SET_CONTENT(WHITE, ROOK, A, 1);
     board CB_SET_CONTENT(WHITE, ROOK, H, 1);
@@ -78,15 +85,18 @@ void Board_init_default(Board_t *board) {
     board->META_CASTLE_H = 3;
     board->win = 0;
     board->turn_nr = 0;
+
+    //Mirror content into bitboards
+    Board_sync(board);
 }
 
-/** @fn ui8 Board_legal_move(Board_t, BoardMove_t)
+/** @fn ui8 Board_legal_move_p(const Board_t *board, BoardMove_t move)
  * @brief Checks if said movement is actually legal
  * @param board Board to be checked
  * @param move Move to be checked
  * @returns 1 - is legal move || 0 - is not || 2 - capture || 5 - en passant capture || 6 - castle queen's || 7 - castle king's || 8 - promotion rook || 9 - promotion knight || 10 - promotion bishop || 11 - promotion queen
  */
-ui8 Board_legal_move(Board_t board, BoardMove_t move) {
+ui8 Board_legal_move_p(const Board_t *board, BoardMove_t move) {
     //Moveset is defined static
     
     //Bound check
@@ -94,20 +104,36 @@ ui8 Board_legal_move(Board_t board, BoardMove_t move) {
         return 0;
 
     //Check pieces
-    switch(board.content[move.from_file][move.from_rank] & ~(CB_WHITE_MASK | CB_BLACK_MASK)) {
+    switch(board->content[move.from_file][move.from_rank] & ~(CB_WHITE_MASK | CB_BLACK_MASK)) {
 
-        //Case for pawn, depends on direction, check board.turn
+        //Case for pawn, depends on direction, check board->turn
         case CB_PAWN: {
-            signed short direction = ((Board_color_field(board, move.from_file, move.from_rank) == 1) ? 1 : -1);
+            signed short direction = ((Board_color_field_p(board, move.from_file, move.from_rank) == 1) ? 1 : -1);
 
             //Promotion generic
             if(((move.from_rank + direction == 7) && (move.to_rank == 0)) || ((move.from_rank + direction == 0) && (move.to_rank == 7))) {
-                switch(move.to_file) {
-                    case 0: return 8;
-                    case 1: return 9;
-                    case 2: return 10;
-                    case 3: return 11;
-                }
+                //to_file selects the piece, special selects the target field
+                if(move.to_file < 0 || move.to_file > 3)
+                    return 0;
+
+                signed short file = move.from_file;
+                if(move.special == 1)
+                    file++;
+                else if(move.special == 2)
+                    file--;
+                else if(move.special != 0)
+                    return 0;
+                if(file < 0 || file > 7)
+                    return 0;
+
+                //Forward requires an empty field, captures require an opposing piece
+                ui8 target = Board_color_field_p(board, file, move.from_rank + direction);
+                if(move.special == 0 && target)
+                    return 0;
+                if(move.special != 0 && (!target || target == Board_color_field_p(board, move.from_file, move.from_rank)))
+                    return 0;
+
+                return 8 + move.to_file;
             }
 
             else if(move.to_rank == 0 || move.to_rank == 7) {
@@ -118,18 +144,19 @@ ui8 Board_legal_move(Board_t board, BoardMove_t move) {
             else if((move.from_rank + direction == move.to_rank) && (abs(move.to_file - move.from_file) < 2)) {
                 //Directly ahead
                 if(move.from_file == move.to_file)
-                    return !Board_color_field(board, move.to_file, move.to_rank);
+                    return !Board_color_field_p(board, move.to_file, move.to_rank);
 
                 //Sidewards (capture)
-                if((direction == 1) && (Board_color_field(board, move.to_file, move.to_rank) == 2))
+                if((direction == 1) && (Board_color_field_p(board, move.to_file, move.to_rank) == 2))
                     return 2;
-                if((direction == -1) && (Board_color_field(board, move.to_file, move.to_rank) == 1))
+                if((direction == -1) && (Board_color_field_p(board, move.to_file, move.to_rank) == 1))
                     return 2;
 
-                //En Passant capture
-                if(board.CB_ALLOW_DEFAULT_SPM) {
-                    if(move.to_file == board.META_PASSANT_FILE) {
-                        if(Board_color_field(board, move.from_file, move.from_rank) != Board_color_field(board, move.to_file, move.from_rank)) {
+                //En Passant capture, onto the empty field behind an opposing pawn that just moved two ranks
+                if(board->CB_ALLOW_DEFAULT_SPM) {
+                    if(move.to_file == board->META_PASSANT_FILE && move.from_rank == ((direction == 1) ? 4 : 3)) {
+                        if(!Board_color_field_p(board, move.to_file, move.to_rank) &&
+                            board->content[move.to_file][move.from_rank] == (CB_PAWN | ((direction == 1) ? CB_BLACK_MASK : CB_WHITE_MASK))) {
                             return 5;
                         }
                     }
@@ -142,7 +169,7 @@ ui8 Board_legal_move(Board_t board, BoardMove_t move) {
             //Move forward by two
             else if((move.from_rank + direction * 2 == move.to_rank) && (move.from_file == move.to_file) && ((move.from_rank == 1) || (move.from_rank == 6))) {
                 //Collision check for both fields
-                if((!Board_color_field(board, move.to_file, move.to_rank)) && (!Board_color_field(board, move.to_file, move.from_rank + direction)))
+                if((!Board_color_field_p(board, move.to_file, move.to_rank)) && (!Board_color_field_p(board, move.to_file, move.from_rank + direction)))
                     return 1;
                 return 0;
             }
@@ -152,305 +179,308 @@ ui8 Board_legal_move(Board_t board, BoardMove_t move) {
         }
         break;
 
-        //Case for rook, any linear direction
+        //Case for sliders, the attack tables stop at the first piece in every direction
         case CB_QUEEN:
         case CB_ROOK:
-            //Direction check
-            if((move.from_rank == move.to_rank) ^ (move.from_file == move.to_file)) {
-                //Collission
-                ui8 i;
-
-                //File moves
-                if(move.from_rank == move.to_rank) {
-                    //Positive move
-                    if(move.from_file < move.to_file)
-                        //Iterate until last field
-                        for(i = move.from_file + 1; i < move.to_file; i++) {
-                            if(Board_color_field(board, i, move.from_rank))
-                                return 0;
-                        }
-
-                    //Negative move
-                    else
-                        //Iterate until last field
-                        for(i = move.from_file - 1; i > move.to_file; i--) {
-                            if(Board_color_field(board, i, move.from_rank))
-                                return 0;
-                        }
-                }
-                
-                //Rank moves
-                else {
-                    //Positive move
-                    if(move.from_rank < move.to_rank)
-                        //Iterate until last field
-                        for(i = move.from_rank + 1; i < move.to_rank; i++) {
-                            if(Board_color_field(board, move.from_file, i))
-                                return 0;
-                        }
-
-                    //Negative move
-                    else
-                        //Iterate until last field
-                        for(i = move.from_rank - 1; i > move.to_rank; i--) {
-                            if(Board_color_field(board, move.from_file, i))
-                                return 0;
-                        }
-                }
-
-                //Collision with own pieces
-                if(((Board_color_field(board, move.from_file, move.from_rank) == 1) && (Board_color_field(board, move.to_file, move.to_rank) == 1)) ||
-                    ((Board_color_field(board, move.from_file, move.from_rank) == 2) && (Board_color_field(board, move.to_file, move.to_rank) == 2)))
-                    return 0;
-                //Capture
-                if(((Board_color_field(board, move.from_file, move.from_rank) == 1) && (Board_color_field(board, move.to_file, move.to_rank) == 2)) ||
-                    ((Board_color_field(board, move.from_file, move.from_rank) == 2) && (Board_color_field(board, move.to_file, move.to_rank) == 1)))
-                    return 2;
-                return 1;
-            }
-
-            //QUEEN STUFF
-            else {
-                if((board.content[move.from_file][move.from_rank] & ~(CB_WHITE_MASK | CB_BLACK_MASK)) != CB_QUEEN)
-                    return 0;
-            }
-
-        case CB_BISHOP:
-            //Same field check
-            if(move.to_rank == move.from_rank) return 0;
-
-            //Direction check
-            if( (move.to_file - move.from_file == move.to_rank - move.from_rank) || (move.to_file - move.from_file == move.from_rank - move.to_rank) ) {
-
-                ui8 i = 1;
-
-                //Positive file
-                if(move.from_file < move.to_file) {
-
-                    //Positive rank
-                    if(move.from_rank < move.to_rank) {
-                        
-                        //Iterate for collision
-                        for(i = 1; i + move.from_file < move.to_file; i++)
-                            if(Board_color_field(board, move.from_file + i, move.from_rank + i))
-                                return 0;
-                    }
+        case CB_BISHOP: {
+            ui8 from = CB_SQUARE(move.from_file, move.from_rank);
+            ui64 occupied = CB_BB_OCCUPIED(board);
+            ui64 attacks = 0;
 
-                    //Negative rank
-                    else {
-                        
-                        //Iterate for collision
-                        for(i = 1; i + move.from_file < move.to_file; i++)
-                            if(Board_color_field(board, move.from_file + i, move.from_rank - i))
-                                return 0;
-                    }
-                }
+            if((board->content[move.from_file][move.from_rank] & ~(CB_WHITE_MASK | CB_BLACK_MASK)) != CB_BISHOP)
+                attacks |= CB_ROOK_ATTACKS(from, occupied);
+            if((board->content[move.from_file][move.from_rank] & ~(CB_WHITE_MASK | CB_BLACK_MASK)) != CB_ROOK)
+                attacks |= CB_BISHOP_ATTACKS(from, occupied);
 
-                //Negative file
-                else {
-
-                    //Positive rank
-                    if(move.from_rank < move.to_rank) {
-                        
-                        //Iterate for collision
-                        for(i = 1; move.from_file - i > move.to_file; i++)
-                            if(Board_color_field(board, move.from_file - i, move.from_rank + i))
-                                return 0;
-                    }
-
-                    //Negative rank
-                    else {
-                        
-                        //Iterate for collision
-                        for(i = 1; move.from_file - i > move.to_file; i++) {
-                            if(Board_color_field(board, move.from_file - i, move.from_rank - i))
-                                return 0;
-                        }
-                    }
-                }
+            if(!(attacks & CB_BIT(CB_SQUARE(move.to_file, move.to_rank))))
+                return 0;
 
-                //Collision with own pieces
-                if(((Board_color_field(board, move.from_file, move.from_rank) == 1) && (Board_color_field(board, move.to_file, move.to_rank) == 1)) ||
-                    ((Board_color_field(board, move.from_file, move.from_rank) == 2) && (Board_color_field(board, move.to_file, move.to_rank) == 2)))
-                    return 0;
-                //Capture
-                if(((Board_color_field(board, move.from_file, move.from_rank) == 1) && (Board_color_field(board, move.to_file, move.to_rank) == 2)) ||
-                    ((Board_color_field(board, move.from_file, move.from_rank) == 2) && (Board_color_field(board, move.to_file, move.to_rank) == 1)))
-                    return 2;
-                return 1;
-            }
-            
-            return 0;
+            //Collision with own pieces
+            if(Board_color_field_p(board, move.from_file, move.from_rank) == Board_color_field_p(board, move.to_file, move.to_rank))
+                return 0;
+            //Capture
+            if(Board_color_field_p(board, move.to_file, move.to_rank))
+                return 2;
+            return 1;
+        }
 
         case CB_KNIGHT: {
 
             //Movement
-            signed int movements[8][2] = {
-                {1,2},
-                {1,-2},
-                {-1,2},
-                {-1,-2},
-                {2,1},
-                {2,-1},
-                {-2,1},
-                {-2,-1},
-            };
-
-            //Check all, valid on one
-            ui8 invalid = 1;
-            for(ui8 i = 0; i < 8 && invalid; i++)
-                if((((signed) move.from_file - (signed) move.to_file) == movements[i][0]) && (((signed) move.from_rank - (signed) move.to_rank) == movements[i][1]))
-                    invalid = 0;
-
-            if(invalid)
+            if(!(CB_KNIGHT_ATTACKS(CB_SQUARE(move.from_file, move.from_rank)) & CB_BIT(CB_SQUARE(move.to_file, move.to_rank))))
                 return 0;
 
             //Capture or not
-            if(!Board_color_field(board, move.to_file, move.to_rank))
+            if(!Board_color_field_p(board, move.to_file, move.to_rank))
                 return 1;
-            else if(((Board_color_field(board, move.from_file, move.from_rank) == 1) && (Board_color_field(board, move.to_file, move.to_rank) == 2)) ||
-                ((Board_color_field(board, move.from_file, move.from_rank) == 2) && (Board_color_field(board, move.to_file, move.to_rank) == 1)))
+            else if(((Board_color_field_p(board, move.from_file, move.from_rank) == 1) && (Board_color_field_p(board, move.to_file, move.to_rank) == 2)) ||
+                ((Board_color_field_p(board, move.from_file, move.from_rank) == 2) && (Board_color_field_p(board, move.to_file, move.to_rank) == 1)))
                 return 2;
             return 0;
         }
         case CB_KING:
 
             //Castling check
-            if(board.CB_ALLOW_DEFAULT_SPM && move.from_file == CB_FILE_E && (move.from_rank == 0 || move.from_rank == 7)) {
+            if(board->CB_ALLOW_DEFAULT_SPM && move.from_file == CB_FILE_E && (move.from_rank == 0 || move.from_rank == 7)) {
                 //White
-                if(Board_color_field(board, move.from_file, move.from_rank) == 1 && Board_color_field(board, move.to_file, move.to_rank) == 1) {
+                if(Board_color_field_p(board, move.from_file, move.from_rank) == 1 && Board_color_field_p(board, move.to_file, move.to_rank) == 1) {
                     //Queen's side
-                    if((board.META_CASTLE_A & 2) && move.to_file == CB_FILE_A && move.to_rank == 0) {
-                        //File B to D must be empty
+                    if((board->META_CASTLE_A & 2) && move.to_file == CB_FILE_A && move.to_rank == 0) {
+                        //Rook must still be there, file B to D must be empty
+                        if(board->content[0][0] != (CB_ROOK | CB_WHITE_MASK)) return 0;
                         for(ui8 i = 1; i < 4; i++)
-                            if(board.content[i][0] != CB_EMPTY) return 0;
+                            if(board->content[i][0] != CB_EMPTY) return 0;
 
-                        //C1 mustn't be defended
-                        if(Board_defended_field(board, 2, 0) & 1) return 0;
+                        //E1, D1 and C1 mustn't be defended
+                        for(ui8 i = 2; i < 5; i++)
+                            if(Board_defended_field_p(board, i, 0) & 1) return 0;
                         return 6;
                     }
 
                     //King's side
-                    if((board.META_CASTLE_H & 2) && move.to_file == CB_FILE_H && move.to_rank == 0) {
-                        //File F and G must be empty
-                        if(board.content[5][0] != CB_EMPTY) return 0;
-                        if(board.content[6][0] != CB_EMPTY) return 0;
-
-                        //G1 mustn't be defended
-                        if(Board_defended_field(board, 6, 0) & 1) return 0;
+                    if((board->META_CASTLE_H & 2) && move.to_file == CB_FILE_H && move.to_rank == 0) {
+                        //Rook must still be there, file F and G must be empty
+                        if(board->content[7][0] != (CB_ROOK | CB_WHITE_MASK)) return 0;
+                        if(board->content[5][0] != CB_EMPTY) return 0;
+                        if(board->content[6][0] != CB_EMPTY) return 0;
+
+                        //E1, F1 and G1 mustn't be defended
+                        for(ui8 i = 4; i < 7; i++)
+                            if(Board_defended_field_p(board, i, 0) & 1) return 0;
                         return 7;
                     }
                 }
 
                 //Black
-                else if(Board_color_field(board, move.from_file, move.from_rank) == 2 && Board_color_field(board, move.to_file, move.to_rank) == 2) {
+                else if(Board_color_field_p(board, move.from_file, move.from_rank) == 2 && Board_color_field_p(board, move.to_file, move.to_rank) == 2) {
                     //Queen's side
-                    if((board.META_CASTLE_A & 1) && move.to_file == CB_FILE_A && move.to_rank == 7) {
-                        //File B to D must be empty
+                    if((board->META_CASTLE_A & 1) && move.to_file == CB_FILE_A && move.to_rank == 7) {
+                        //Rook must still be there, file B to D must be empty
+                        if(board->content[0][7] != (CB_ROOK | CB_BLACK_MASK)) return 0;
                         for(ui8 i = 1; i < 4; i++)
-                            if(board.content[i][7] != CB_EMPTY) return 0;
+                            if(board->content[i][7] != CB_EMPTY) return 0;
 
-                        //C8 mustn't be defended
-                        if(Board_defended_field(board, 2, 7) & 2) return 0;
+                        //E8, D8 and C8 mustn't be defended
+                        for(ui8 i = 2; i < 5; i++)
+                            if(Board_defended_field_p(board, i, 7) & 2) return 0;
                         return 6;
                     }
 
                     //King's side
-                    if((board.META_CASTLE_H & 1) && move.to_file == CB_FILE_H && move.to_rank == 7) {
-                        //File F and G must be empty
-                        if(board.content[5][7] != CB_EMPTY) return 0;
-                        if(board.content[6][7] != CB_EMPTY) return 0;
-
-                        //G8 mustn't be defended
-                        if(Board_defended_field(board, 6, 7) & 2) return 0;
+                    if((board->META_CASTLE_H & 1) && move.to_file == CB_FILE_H && move.to_rank == 7) {
+                        //Rook must still be there, file F and G must be empty
+                        if(board->content[7][7] != (CB_ROOK | CB_BLACK_MASK)) return 0;
+                        if(board->content[5][7] != CB_EMPTY) return 0;
+                        if(board->content[6][7] != CB_EMPTY) return 0;
+
+                        //E8, F8 and G8 mustn't be defended
+                        for(ui8 i = 4; i < 7; i++)
+                            if(Board_defended_field_p(board, i, 7) & 2) return 0;
                         return 7;
                     }
                 }
             }
 
-            //Movement
-            if(!((abs((signed) move.from_file - (signed) move.to_file) < 2) && (abs((signed) move.from_rank - (signed) move.to_rank) < 2)))
+            //Movement, a king never attacks its own field
+            if(!(CB_KING_ATTACKS(CB_SQUARE(move.from_file, move.from_rank)) & CB_BIT(CB_SQUARE(move.to_file, move.to_rank))))
                 return 0;
 
-            //Cant not move
-            if(move.to_file == move.from_file && move.to_rank == move.from_rank) return 0;
-
             //Check if field is in check
-            if(Board_defended_field(board, move.to_file, move.to_rank) & Board_color_field(board, move.from_file, move.from_rank))
+            if(Board_defended_field_p(board, move.to_file, move.to_rank) & Board_color_field_p(board, move.from_file, move.from_rank))
                 return 0;
 
             //Capture
-            if(!Board_color_field(board, move.to_file, move.to_rank))
+            if(!Board_color_field_p(board, move.to_file, move.to_rank))
                 return 1;
-            else if(((Board_color_field(board, move.from_file, move.from_rank) == 1) && (Board_color_field(board, move.to_file, move.to_rank) == 2)) ||
-                ((Board_color_field(board, move.from_file, move.from_rank) == 2) && (Board_color_field(board, move.to_file, move.to_rank) == 1)))
+            else if(((Board_color_field_p(board, move.from_file, move.from_rank) == 1) && (Board_color_field_p(board, move.to_file, move.to_rank) == 2)) ||
+                ((Board_color_field_p(board, move.from_file, move.from_rank) == 2) && (Board_color_field_p(board, move.to_file, move.to_rank) == 1)))
                 return 2;
             return 0;
         default: return 0;
     }
 }
 
-/** @fn ui8 Board_defended_field(Board_t board, ui8 file, ui8 rank)
+/** @fn ui8 Board_legal_move(Board_t board, BoardMove_t move)
+ * @brief By value variant of Board_legal_move_p
+ */
+ui8 Board_legal_move(Board_t board, BoardMove_t move) {
+    return Board_legal_move_p(&board, move);
+}
+
+/** @fn ui8 Board_defended_field_p(const Board_t *board, ui8 file, ui8 rank)
  * @brief Checks if a field is defended by any or both colors
  * @param board Board to be checked
  * @param file File A-G (0-7 in index 1)
  * @param rank Rank 1-8 (0-7 in index 2)
  * @returns 0 - undefended || 1 - defended by black || 2 - defended by white || 3 - defended by both
  */
-ui8 Board_defended_field(Board_t board, ui8 file, ui8 rank) {
-	BoardMove_t move = {.to_file = file, .to_rank = rank};
+ui8 Board_defended_field_p(const Board_t *board, ui8 file, ui8 rank) {
+	ui64 attackers = Board_attackers_to(board, CB_SQUARE(file, rank), CB_BB_OCCUPIED(board));
 
 	ui8 ret = 0;
+	if(attackers & CB_BB_COLOR(board, 0))
+		ret |= 2;
+	if(attackers & CB_BB_COLOR(board, 1))
+		ret |= 1;
 
-	for(ui8 f = 0; f < 8; f++) for(ui8 r = 0; r < 8; r++) {
-		
-		//Disallow king recursion
-		if((board.content[f][r] & ~(CB_WHITE_MASK | CB_BLACK_MASK)) == CB_KING) {
-			if((abs((signed) f - (signed) file) < 2) && (abs((signed) r - (signed) rank) < 2) && !(file == f && rank == r))
-				ret |= (3 - Board_color_field(board, f, r));
-		}
+	return ret;
+}
 
-		//Get if piece
-		else if(board.content[f][r] != CB_EMPTY) {
-			move.from_file = f;
-			move.from_rank = r;
-            // This checks if a piece can move to a field.
-            // Pawns can move forward which used to cause the king to be unable to move infront of the enemy pawn.
-            // This check will require pawn checks to be 2 (capture)
-            ui8 st = Board_legal_move(board, move);
-            if((board.content[f][r] & ~(CB_WHITE_MASK | CB_BLACK_MASK)) != CB_PAWN) {
-                if(st == 1) {
-                    if(Board_color_field(board, f, r) == 1)
-                        ret |= 2;
-                    else
-                        ret |= 1;
-                }
-			}
-            else if(st == 2) {
-                if(Board_color_field(board, f, r) == 1)
-                    ret |= 2;
-                else
-                    ret |= 1;
-            }
-		}
-	}
+/** @fn ui8 Board_defended_field(Board_t board, ui8 file, ui8 rank)
+ * @brief By value variant of Board_defended_field_p
+ */
+ui8 Board_defended_field(Board_t board, ui8 file, ui8 rank) {
+    return Board_defended_field_p(&board, file, rank);
+}
 
-	return ret;
+/** @fn ui64 Board_attackers_to(const Board_t *board, ui8 square, ui64 occupied)
+ * @brief Gets every piece attacking a square by looking outward from the square with each piece's attack pattern
+ * @param board Board to be checked
+ * @param square Square index (CB_SQUARE)
+ * @param occupied Occupancy blocking the sliders, usually CB_BB_OCCUPIED
+ * @returns Bitboard of attackers of both colors, mask with CB_BB_COLOR for one side
+ */
+ui64 Board_attackers_to(const Board_t *board, ui8 square, ui64 occupied) {
+    //A pawn attacks the square if a pawn of the other color on the square would attack it back
+    return (CB_PAWN_ATTACKS(1, square) & CB_BB_PIECE(board, 0, CB_PAWN)) |
+        (CB_PAWN_ATTACKS(0, square) & CB_BB_PIECE(board, 1, CB_PAWN)) |
+        (CB_KNIGHT_ATTACKS(square) & (CB_BB_PIECE(board, 0, CB_KNIGHT) | CB_BB_PIECE(board, 1, CB_KNIGHT))) |
+        (CB_KING_ATTACKS(square) & (CB_BB_PIECE(board, 0, CB_KING) | CB_BB_PIECE(board, 1, CB_KING))) |
+        (CB_BISHOP_ATTACKS(square, occupied) & (CB_BB_PIECE(board, 0, CB_BISHOP) | CB_BB_PIECE(board, 1, CB_BISHOP) |
+            CB_BB_PIECE(board, 0, CB_QUEEN) | CB_BB_PIECE(board, 1, CB_QUEEN))) |
+        (CB_ROOK_ATTACKS(square, occupied) & (CB_BB_PIECE(board, 0, CB_ROOK) | CB_BB_PIECE(board, 1, CB_ROOK) |
+            CB_BB_PIECE(board, 0, CB_QUEEN) | CB_BB_PIECE(board, 1, CB_QUEEN)));
 }
 
 /** @fn ui8 Board_color_field(Board_t board, ui8 file, ui8 rank)
- * @brief Gets a field's color, or 0 if empty
- * @param board Board to be checked
+ * @brief By value variant of Board_color_field_p (board.h)
+ */
+ui8 Board_color_field(Board_t board, ui8 file, ui8 rank) {
+    return Board_color_field_p(&board, file, rank);
+}
+
+/** @fn static void Board_track_add(Board_t *board, ui8 square, ui8 piece)
+ * @brief Adds a piece to the bitboards, the piece list, the keys, the evaluation totals and the king square of its color
+ */
+static void Board_track_add(Board_t *board, ui8 square, ui8 piece) {
+    ui8 color = CB_PIECE_COLOR(piece);
+
+    board->bitboards[color][CB_EMPTY] |= CB_BIT(square);
+    board->bitboards[color][CB_PIECE_TYPE(piece)] |= CB_BIT(square);
+
+    board->piece_index[square] = board->piece_count[color];
+    board->piece_list[color][board->piece_count[color]++] = square;
+    board->key ^= CB_ZOBRIST_PIECE(piece, square);
+    if(CB_PIECE_TYPE(piece) == CB_PAWN)
+        board->pawn_key ^= CB_ZOBRIST_PIECE(piece, square);
+
+    board->psqt_mg += color ? -CB_PSQT(0, piece, square) : CB_PSQT(0, piece, square);
+    board->psqt_eg += color ? -CB_PSQT(1, piece, square) : CB_PSQT(1, piece, square);
+    board->phase += Board_phase_weights[CB_PIECE_TYPE(piece)];
+    if(board->nnue)
+        Board_nnue_add(board->nnue, piece, square);
+
+    if(CB_PIECE_TYPE(piece) == CB_KING)
+        board->king_square[color] = square;
+}
+
+/** @fn static void Board_track_remove(Board_t *board, ui8 square, ui8 piece)
+ * @brief Removes a piece from the bitboards, the piece list, the keys, the evaluation totals and the king square of its color
+ */
+static void Board_track_remove(Board_t *board, ui8 square, ui8 piece) {
+    ui8 color = CB_PIECE_COLOR(piece);
+
+    board->bitboards[color][CB_EMPTY] &= ~CB_BIT(square);
+    board->bitboards[color][CB_PIECE_TYPE(piece)] &= ~CB_BIT(square);
+
+    //Fill the gap with the last entry
+    ui8 index = board->piece_index[square];
+    ui8 last = board->piece_list[color][--board->piece_count[color]];
+    board->piece_list[color][index] = last;
+    board->piece_index[last] = index;
+    board->key ^= CB_ZOBRIST_PIECE(piece, square);
+    if(CB_PIECE_TYPE(piece) == CB_PAWN)
+        board->pawn_key ^= CB_ZOBRIST_PIECE(piece, square);
+
+    board->psqt_mg -= color ? -CB_PSQT(0, piece, square) : CB_PSQT(0, piece, square);
+    board->psqt_eg -= color ? -CB_PSQT(1, piece, square) : CB_PSQT(1, piece, square);
+    board->phase -= Board_phase_weights[CB_PIECE_TYPE(piece)];
+    if(board->nnue)
+        Board_nnue_remove(board->nnue, piece, square);
+
+    //Edited boards may hold more than one king
+    if(CB_PIECE_TYPE(piece) == CB_KING)
+        board->king_square[color] = CB_BB_PIECE(board, color, CB_KING) ? __builtin_ctzll(CB_BB_PIECE(board, color, CB_KING)) : CB_NO_SQUARE;
+}
+
+/** @fn void Board_set_field(Board_t *board, ui8 file, ui8 rank, ui8 piece)
+ * @brief Sets a field's content and updates the bitboards, piece lists, king squares and key accordingly
+ * @param board Pointer to board to be changed
  * @param file File A-G (0-7 in index 1)
  * @param rank Rank 1-8 (0-7 in index 2)
- * @returns 0 - empty || 1 - white || 2 - black
+ * @param piece Piece including color mask, or CB_EMPTY
+ * @returns none
  */
-ui8 Board_color_field(Board_t board, ui8 file, ui8 rank) {
-    if(board.content[ file ][ rank ] & CB_WHITE_MASK)
-        return 1;
-    else if(board.content[ file ][ rank ] & CB_BLACK_MASK)
-        return 2;
-    return 0;
+void Board_set_field(Board_t *board, ui8 file, ui8 rank, ui8 piece) {
+    ui8 square = CB_SQUARE(file, rank);
+    ui8 old = board->content[file][rank];
+
+    //Remove previous piece
+    if(old != CB_EMPTY && CB_PIECE_TYPE(old) <= CB_KING)
+        Board_track_remove(board, square, old);
+
+    //Place new piece
+    if(piece != CB_EMPTY && CB_PIECE_TYPE(piece) <= CB_KING)
+        Board_track_add(board, square, piece);
+
+    board->content[file][rank] = piece;
+}
+
+/** @fn void Board_sync(Board_t *board)
+ * @brief Rebuilds the bitboards, piece lists, king squares, key and evaluation totals from the raw content, required after writing content or flags directly
+ * @param board Pointer to board to be synced
+ * @returns none
+ */
+void Board_sync(Board_t *board) {
+    Board_init_tables();
+
+    for(ui8 c = 0; c < 2; c++) {
+        for(ui8 p = 0; p < 7; p++) board->bitboards[c][p] = 0;
+        board->piece_count[c] = 0;
+        board->king_square[c] = CB_NO_SQUARE;
+    }
+    board->key = CB_ZOBRIST_STATE(board);
+    board->pawn_key = 0;
+    board->psqt_mg = 0;
+    board->psqt_eg = 0;
+    board->phase = 0;
+    if(board->nnue)
+        Board_nnue_reset(board->nnue);
+
+    for(ui8 f = 0; f < 8; f++) for(ui8 r = 0; r < 8; r++) {
+        ui8 piece = board->content[f][r];
+        if(piece == CB_EMPTY || CB_PIECE_TYPE(piece) > CB_KING)
+            continue;
+        Board_track_add(board, CB_SQUARE(f, r), piece);
+    }
+}
+
+/** @fn ui64 Board_compute_key(const Board_t *board)
+ * @brief Computes the zobrist key from scratch, the incrementally kept board->key always equals this
+ * @param board Board to be hashed
+ * @returns Zobrist key
+ */
+ui64 Board_compute_key(const Board_t *board) {
+    ui64 key = CB_ZOBRIST_STATE(board);
+
+    for(ui8 f = 0; f < 8; f++) for(ui8 r = 0; r < 8; r++) {
+        ui8 piece = board->content[f][r];
+        if(piece == CB_EMPTY || CB_PIECE_TYPE(piece) > CB_KING)
+            continue;
+        key ^= CB_ZOBRIST_PIECE(piece, CB_SQUARE(f, r));
+    }
+
+    return key;
 }
 
 /** @fn ui8 Board_apply(Board_t *board, BoardMove_t move)
@@ -460,32 +490,10 @@ ui8 Board_color_field(Board_t board, ui8 file, ui8 rank) {
  * @returns 0 - unsuccessful || >0 - successful with flags || 125 - white wins || 126 - black wins || 127 - draw or stalemate
  */
 ui8 Board_apply(Board_t *board, BoardMove_t move) {
-    //Swap tool
-    #define swret                                                                                       \
-    /* If the applied move doesn't resolve or causes a check, the move can't be done */                 \
-    if(Board_in_check(*board, (board->turn == CB_TURN_WHITE) ? 1 : 2)) {                                \
-        Board_clone(board, backup);                                                                     \
-        return 0;                                                                                       \
-    }                                                                                                   \
-    /* Swap and count turn */                                                                           \
-    board->turn = (board->turn == CB_TURN_WHITE) ? CB_TURN_BLACK : CB_TURN_WHITE;                       \
-    board->turn_nr++;                                                                                   \
-    /* Check for checkmate */                                                                           \
-    if(Board_in_mate(*board, (board->turn == CB_TURN_WHITE) ? 1 : 2)) {                                 \
-        board->win = ((board->turn == CB_TURN_WHITE) ? 2 : 1);                                          \
-        return ((board->turn == CB_TURN_WHITE) ? 126u : 125u);                                          \
-    }                                                                                                   \
-    /* Check for stalemate */                                                                           \
-    if(!stalemate_check_flag && Board_in_stale(*board, (board->turn == CB_TURN_WHITE) ? 1 : 2)) {       \
-        board->win = 3;                                                                                 \
-        return 127u;                                                                                    \
-    }                                                                                                   \
-    return
-
-    Board_t backup;
-    Board_clone(&backup, *board);
-
-    ui8 curcol = Board_color_field(*board, move.from_file, move.from_rank);
+    BoardUndo_t records[1];
+    BoardUndoStack_t stack = CB_UNDO_STACK(records);
+
+    ui8 curcol = Board_color_field_p(board, move.from_file, move.from_rank);
 
     //Step 0: Turn check
     if(curcol == 1 && board->turn != CB_TURN_WHITE)
@@ -494,235 +502,334 @@ ui8 Board_apply(Board_t *board, BoardMove_t move) {
         return 0;
 
     //Step 1: Validity check
-    ui8 legal = Board_legal_move(*board, move);
+    ui8 legal = Board_legal_move_p(board, move);
     if(!legal)
         return 0;
 
-    //Get this piece and clear it from the board
-    ui8 piece = board->content[move.from_file][move.from_rank];
-    board->content[move.from_file][move.from_rank] = CB_EMPTY;
+    //Step 2: Move the pieces, swap and count turn
+    move.code = legal;
+    Board_make_move(board, move, &stack);
+
+    //Step 3: If the applied move doesn't resolve or causes a check, the move can't be done
+    if(Board_in_check_p(board, curcol)) {
+        Board_unmake_move(board, &stack);
+        return 0;
+    }
+
+    //Step 4: Check for checkmate
+    if(Board_in_mate_p(board, (board->turn == CB_TURN_WHITE) ? 1 : 2)) {
+        board->win = ((board->turn == CB_TURN_WHITE) ? 2 : 1);
+        return ((board->turn == CB_TURN_WHITE) ? 126u : 125u);
+    }
+
+    //Step 5: Check for stalemate
+    if(Board_in_stale_p(board, (board->turn == CB_TURN_WHITE) ? 1 : 2)) {
+        board->win = 3;
+        return 127u;
+    }
+    return legal;
+}
 
-    //Step 2: Evaluate special move
+/** @fn static void Board_clear_corner(Board_t *board, ui8 file, ui8 rank)
+ * @brief A move from or onto a corner field moves or captures that rook, the corner's castle flag is cleared
+ */
+static void Board_clear_corner(Board_t *board, ui8 file, ui8 rank) {
+    ui8 mask = (rank == 0) ? 2 : ((rank == 7) ? 1 : 0);
+
+    if(file == CB_FILE_A)
+        board->META_CASTLE_A &= ~mask;
+    if(file == CB_FILE_H)
+        board->META_CASTLE_H &= ~mask;
+}
+
+/** @fn static void Board_play_move(Board_t *board, BoardMove_t move, BoardUndo_t *undo, ui8 curcol)
+ * @brief Moves the pieces and updates flags and turn of a validated move, filling the capture fields of its undo record
+ */
+static void Board_play_move(Board_t *board, BoardMove_t move, BoardUndo_t *undo, ui8 curcol) {
+    ui8 legal = move.code;
+    ui8 piece = undo->piece;
+
+    //Clear it from the board, swap and count turn
+    Board_set_field(board, move.from_file, move.from_rank, CB_EMPTY);
+    board->turn = (board->turn == CB_TURN_WHITE) ? CB_TURN_BLACK : CB_TURN_WHITE;
+    board->turn_nr++;
+
+    //Step 1: Evaluate special move
     //En passant capture
     if(legal == 5) {
-        board->content[move.to_file][move.from_rank] = CB_EMPTY;
-        board->content[move.to_file][move.to_rank] = piece;
+        undo->captured = board->content[move.to_file][move.from_rank];
+        undo->captured_rank = move.from_rank;
+        Board_set_field(board, move.to_file, move.from_rank, CB_EMPTY);
+        Board_set_field(board, move.to_file, move.to_rank, piece);
         board->META_PASSANT_FILE = 8;
-        swret 5;
+        return;
     }
     board->META_PASSANT_FILE = 8;
-    //Promotion
+    //Promotion, the target has been validated by Board_legal_move
     if(legal > 7 && legal < 12) {
+        piece &= CB_WHITE_MASK | CB_BLACK_MASK;
         switch(legal) {
-            case 8:
-                piece &= ~CB_PAWN;
-                piece |=  CB_ROOK;
-            break;
-            case 9:
-                piece &= ~CB_PAWN;
-                piece |=  CB_KNIGHT;
-            break;
-            case 10:
-                piece &= ~CB_PAWN;
-                piece |=  CB_BISHOP;
-            break;
-            case 11:
-                piece &= ~CB_PAWN;
-                piece |=  CB_QUEEN;
-            break;
+            case 8: piece |= CB_ROOK; break;
+            case 9: piece |= CB_KNIGHT; break;
+            case 10: piece |= CB_BISHOP; break;
+            case 11: piece |= CB_QUEEN; break;
         }
 
-        //Direction
+        //Direction and capture side
         signed short direction = (curcol == 1) ? 1 : -1;
         ui8 rank = move.from_rank + direction;
         ui8 file = move.from_file;
-
-        //Extra capture check
-        if(move.special == 1 && (Board_color_field(*board, move.from_file - 1, move.from_rank + direction) != Board_color_field(*board, move.from_file, move.from_rank))) {
-            file++;
-        }
-        else if(move.special == 2 && (Board_color_field(*board, move.from_file + 1, move.from_rank + direction) != Board_color_field(*board, move.from_file, move.from_rank))) {
-            file--;
-        }
-        else if(move.special == 0 && !Board_color_field(*board, file, rank));
-        //Neither forwards nor capture matches
-        else {
-            piece &= CB_WHITE_MASK | CB_BLACK_MASK;
-            piece |= CB_PAWN;
-
-            board->content[move.from_file][move.from_rank] = piece;
-            return 0;
-        }
-
-        //Return
-        board->content[file][rank] = piece;
-        swret legal;
+        if(move.special == 1) file++;
+        if(move.special == 2) file--;
+
+        undo->captured = board->content[file][rank];
+        undo->captured_file = file;
+        undo->captured_rank = rank;
+        Board_set_field(board, file, rank, piece);
+        return;
     }
     //Queen's side castle
     if(legal == 6) {
         ui8 piecerook = board->content[move.to_file][move.to_rank];
-        board->content[move.to_file][move.to_rank] = CB_EMPTY;
+        Board_set_field(board, move.to_file, move.to_rank, CB_EMPTY);
         board->META_CASTLE_A &= ~(3-curcol);
         board->META_CASTLE_H &= ~(3-curcol);
-        board->content[CB_FILE_C][move.to_rank] = piece;
-        board->content[CB_FILE_D][move.to_rank] = piecerook;
-        swret 6;
+        Board_set_field(board, CB_FILE_C, move.to_rank, piece);
+        Board_set_field(board, CB_FILE_D, move.to_rank, piecerook);
+        return;
     }
     //King's side castle
     if(legal == 7) {
         ui8 piecerook = board->content[move.to_file][move.to_rank];
-        board->content[move.to_file][move.to_rank] = CB_EMPTY;
+        Board_set_field(board, move.to_file, move.to_rank, CB_EMPTY);
         board->META_CASTLE_A &= ~(3-curcol);
         board->META_CASTLE_H &= ~(3-curcol);
-        board->content[CB_FILE_G][move.to_rank] = piece;
-        board->content[CB_FILE_F][move.to_rank] = piecerook;
-        swret 7;
+        Board_set_field(board, CB_FILE_G, move.to_rank, piece);
+        Board_set_field(board, CB_FILE_F, move.to_rank, piecerook);
+        return;
     }
 
-    //Step 3: King's or Rook's move clearing meta castle flag
+    //Step 2: King's move clearing meta castle flag, rooks are handled by Board_clear_corner
     //King resets flags for both
     if((piece & ~(CB_WHITE_MASK | CB_BLACK_MASK)) == CB_KING) {
         board->META_CASTLE_A &= ~(3-curcol);
         board->META_CASTLE_H &= ~(3-curcol);
     }
-    //Rook A resets A flag
-    if((piece & ~(CB_WHITE_MASK | CB_BLACK_MASK)) == CB_ROOK) {
-        board->META_CASTLE_A &= ~(3-curcol);
-    }
-    //and Rook H resets H flag
-    if((piece & ~(CB_WHITE_MASK | CB_BLACK_MASK)) == CB_ROOK) {
-        board->META_CASTLE_H &= ~(3-curcol);
-    }
 
-    //Step 4: Check Pawn double rank and set en passant flag
+    //Step 3: Check Pawn double rank and set en passant flag
     if((piece & ~(CB_WHITE_MASK | CB_BLACK_MASK)) == CB_PAWN && (abs((signed) move.from_rank - (signed) move.to_rank) == 2)) {
         board->META_PASSANT_FILE = move.from_file;
     }
 
-    //Step 5: Move the piece to the field, possibly erasing another piece
-    board->content[move.to_file][move.to_rank] = piece;
-    swret legal;
+    //Step 4: Move the piece to the field, possibly erasing another piece
+    undo->captured = board->content[move.to_file][move.to_rank];
+    Board_set_field(board, move.to_file, move.to_rank, piece);
 }
 
-/** @fn ui8 Board_in_check(Board_t board, ui8 color)
+/** @fn ui8 Board_make_move(Board_t *board, BoardMove_t move, BoardUndoStack_t *stack)
+ * @brief Plays a validated move in place and pushes an undo record, without check or game end handling
+ * @param board Pointer to board to be played on
+ * @param move Move to play, move.code holds its Board_legal_move result (computed if 0)
+ * @param stack Caller-owned undo stack
+ * @returns Board_legal_move result of the move || 0 - invalid move or stack full
+ */
+ui8 Board_make_move(Board_t *board, BoardMove_t move, BoardUndoStack_t *stack) {
+    if(stack->size >= stack->capacity)
+        return 0;
+
+    ui8 legal = move.code ? move.code : Board_legal_move_p(board, move);
+    if(!legal)
+        return 0;
+    move.code = legal;
+
+    ui8 curcol = Board_color_field_p(board, move.from_file, move.from_rank);
+
+    //Get this piece and remember the previous state
+    ui8 piece = board->content[move.from_file][move.from_rank];
+
+    BoardUndo_t *undo = &stack->records[stack->size++];
+    undo->move = move;
+    undo->piece = piece;
+    undo->captured = CB_EMPTY;
+    undo->captured_file = move.to_file;
+    undo->captured_rank = move.to_rank;
+    undo->META_CASTLE_A = board->META_CASTLE_A;
+    undo->META_CASTLE_H = board->META_CASTLE_H;
+    undo->META_PASSANT_FILE = board->META_PASSANT_FILE;
+    undo->win = board->win;
+    undo->key = board->key;
+
+    //Flags and turn are hashed as a whole, take them out before and back in after the move
+    board->key ^= CB_ZOBRIST_STATE(board);
+    Board_play_move(board, move, undo, curcol);
+    Board_clear_corner(board, move.from_file, move.from_rank);
+    Board_clear_corner(board, undo->captured_file, undo->captured_rank);
+    board->key ^= CB_ZOBRIST_STATE(board);
+
+    return legal;
+}
+
+/** @fn ui8 Board_make_null_move(Board_t *board, BoardUndoStack_t *stack)
+ * @brief Passes the turn without moving, for null move pruning. The en passant file is cleared, Board_unmake_move takes it back
+ * @param board Pointer to board to be played on, the side in turn must not be in check
+ * @param stack Caller-owned undo stack, the record has move code 0
+ * @returns 1 - passed || 0 - stack full
+ */
+ui8 Board_make_null_move(Board_t *board, BoardUndoStack_t *stack) {
+    if(stack->size >= stack->capacity)
+        return 0;
+
+    BoardUndo_t *undo = &stack->records[stack->size++];
+    undo->move = (BoardMove_t) {0};
+    undo->piece = CB_EMPTY;
+    undo->captured = CB_EMPTY;
+    undo->META_CASTLE_A = board->META_CASTLE_A;
+    undo->META_CASTLE_H = board->META_CASTLE_H;
+    undo->META_PASSANT_FILE = board->META_PASSANT_FILE;
+    undo->win = board->win;
+    undo->key = board->key;
+
+    board->key ^= CB_ZOBRIST_STATE(board);
+    board->META_PASSANT_FILE = 8;
+    board->turn = (board->turn == CB_TURN_WHITE) ? CB_TURN_BLACK : CB_TURN_WHITE;
+    board->turn_nr++;
+    board->key ^= CB_ZOBRIST_STATE(board);
+    return 1;
+}
+
+/** @fn void Board_unmake_move(Board_t *board, BoardUndoStack_t *stack)
+ * @brief Takes back the latest move made with Board_make_move or Board_make_null_move and pops its undo record
+ * @param board Pointer to board the move was played on
+ * @param stack Caller-owned undo stack
+ * @returns none
+ */
+void Board_unmake_move(Board_t *board, BoardUndoStack_t *stack) {
+    if(!stack->size)
+        return;
+
+    BoardUndo_t *undo = &stack->records[--stack->size];
+    BoardMove_t move = undo->move;
+
+    //Pieces back, a null move only changed the flags and the turn
+    if(move.code) {
+        //Castling, king and rook back to their origin
+        if(move.code == 6 || move.code == 7) {
+            ui8 king_file = (move.code == 6) ? CB_FILE_C : CB_FILE_G;
+            ui8 rook_file = (move.code == 6) ? CB_FILE_D : CB_FILE_F;
+            ui8 piecerook = board->content[rook_file][move.to_rank];
+            Board_set_field(board, king_file, move.to_rank, CB_EMPTY);
+            Board_set_field(board, rook_file, move.to_rank, CB_EMPTY);
+            Board_set_field(board, move.to_file, move.to_rank, piecerook);
+        }
+
+        //Promotion, the target is where the captured piece was
+        else if(move.code > 7 && move.code < 12) {
+            Board_set_field(board, undo->captured_file, undo->captured_rank, undo->captured);
+        }
+
+        //Any other move, restore the captured piece which differs from the target on en passant
+        else {
+            Board_set_field(board, move.to_file, move.to_rank, CB_EMPTY);
+            Board_set_field(board, undo->captured_file, undo->captured_rank, undo->captured);
+        }
+
+        Board_set_field(board, move.from_file, move.from_rank, undo->piece);
+    }
+
+    //Restore flags, swap and count back turn
+    board->META_CASTLE_A = undo->META_CASTLE_A;
+    board->META_CASTLE_H = undo->META_CASTLE_H;
+    board->META_PASSANT_FILE = undo->META_PASSANT_FILE;
+    board->win = undo->win;
+    board->key = undo->key;
+    board->turn = (board->turn == CB_TURN_WHITE) ? CB_TURN_BLACK : CB_TURN_WHITE;
+    board->turn_nr--;
+}
+
+/** @fn ui8 Board_in_check_p(const Board_t *board, ui8 color)
  * @brief Gets if a color is in check
  * @param board To be checked
  * @param color 1 = white, 2 = black
  * @returns 1 = in check || 0 = not
  */
-ui8 Board_in_check(Board_t board, ui8 color) {
+ui8 Board_in_check_p(const Board_t *board, ui8 color) {
     //Get king of color
-    ui8 mask = (color == 1) ? CB_WHITE_MASK : CB_BLACK_MASK;
-
-    ui8 kfile;
-    ui8 krank;
+    ui8 king = board->king_square[color - 1];
 
-    for(ui8 r = 0; r < 8; r++) for(ui8 f = 0; f < 8; f++) {
-        if(board.content[f][r] == (mask | CB_KING)) {
-            kfile = f;
-            krank = r;
-            break;
-        }
-    }
-
-    //Stuff
-    BoardMove_t move = {.to_file = kfile, .to_rank = krank};
+    //No king, no check
+    if(king == CB_NO_SQUARE)
+        return 0;
 
-    for(ui8 r = 0; r < 8; r++) for(ui8 f = 0; f < 8; f++) {
-        move.from_file = f;
-        move.from_rank = r;
-        if(board.content[f][r] != CB_EMPTY, Board_legal_move(board, move) == 2)
-            return 1;
-    }
-    return 0;
+    //Any attacker of the other color
+    return (Board_attackers_to(board, king, CB_BB_OCCUPIED(board)) & CB_BB_COLOR(board, 2 - color)) != 0;
 }
 
 /** @fn ui8 Board_in_check(Board_t board, ui8 color)
+ * @brief By value variant of Board_in_check_p
+ */
+ui8 Board_in_check(Board_t board, ui8 color) {
+    return Board_in_check_p(&board, color);
+}
+
+/** @fn ui8 Board_in_mate_p(const Board_t *board, ui8 color)
  * @brief Gets if a color is in checkmate
  * @param board To be checked
  * @param color 1 = white, 2 = black
  * @returns 1 = in check || 0 = not
  */
-ui8 Board_in_mate(Board_t board, ui8 color) {
-    if(!Board_in_check(board, color))
+ui8 Board_in_mate_p(const Board_t *board, ui8 color) {
+    if(!Board_in_check_p(board, color))
         return 0;
 
-    Board_t check;
-    Board_clone(&check, board);
-
-    //Check every piece and every move
-    BoardMove_t move;
+    //Checkmate if no legal move is left
+    return !Board_color_has_legal_move(board, color);
+}
 
-    for(move.from_file = 0; move.from_file < 8; move.from_file++)
-    for(move.from_rank = 0; move.from_rank < 8; move.from_rank++)
-    for(move.to_file = 0; move.to_file < 8; move.to_file++)
-    for(move.to_rank = 0; move.to_rank < 8; move.to_rank++) {
-        //Prevent overload
-        if(board.content[move.from_file][move.from_rank] == CB_EMPTY)
-            continue;
-        //Upon legal move
-        ui8 ret = Board_apply(&check, move);
-        if(!(ret == 0 || ret == 3 || ret == 4)) {
-            //printf("\n<%i,%i,%i,%i>\n", move.from_file, move.from_rank, move.to_file, move.to_rank);
-            return 0;
-        }
-    }
-    
-    return 1;
+/** @fn ui8 Board_in_mate(Board_t board, ui8 color)
+ * @brief By value variant of Board_in_mate_p
+ */
+ui8 Board_in_mate(Board_t board, ui8 color) {
+    return Board_in_mate_p(&board, color);
 }
 
-/** @fn ui8 Board_in_stale(Board_t board, ui8 color)
+/** @fn ui8 Board_in_stale_p(const Board_t *board, ui8 color)
  * @brief Gets if a color is in stalemates
  * @param board To be checked
  * @param color 1 = white, 2 = black
  * @returns 1 = in stalemate || 0 = not
  */
-ui8 Board_in_stale(Board_t board, ui8 color) {
-    if(Board_in_check(board, color))
+ui8 Board_in_stale_p(const Board_t *board, ui8 color) {
+    if(Board_in_check_p(board, color))
         return 0;
 
-    Board_t check;
-    Board_clone(&check, board);
-
-    //Check every piece and every move
-    BoardMove_t move;
+    //Stalemate if no legal move is left
+    return !Board_color_has_legal_move(board, color);
+}
 
-    stalemate_check_flag = 1;
-    for(move.from_file = 0; move.from_file < 8; move.from_file++)
-    for(move.from_rank = 0; move.from_rank < 8; move.from_rank++)
-    for(move.to_file = 0; move.to_file < 8; move.to_file++)
-    for(move.to_rank = 0; move.to_rank < 8; move.to_rank++) {
-        //Prevent overload
-        if(board.content[move.from_file][move.from_rank] == CB_EMPTY)
-            continue;
-        //Upon legal move
-        ui8 ret = Board_apply(&check, move);
-        if(!(ret == 0 || ret == 3 || ret == 4)) {
-            //printf("\n<%i,%i,%i,%i>\n", move.from_file, move.from_rank, move.to_file, move.to_rank);
-            stalemate_check_flag = 0;
-            return 0;
-        }
-    }
-    
-    stalemate_check_flag = 0;
-    return 1;
+/** @fn ui8 Board_in_stale(Board_t board, ui8 color)
+ * @brief By value variant of Board_in_stale_p
+ */
+ui8 Board_in_stale(Board_t board, ui8 color) {
+    return Board_in_stale_p(&board, color);
 }
 
-/** @fn ui8 Board_clone(Board_t *into, Board_t from)
+/** @fn void Board_clone_p(Board_t *into, const Board_t *from)
  * @brief Clones board content
  * @param into Board to be cloned into
  * @param from Original board
  * @returns none
  */
+void Board_clone_p(Board_t *into, const Board_t *from) {
+    //Everything, including the bitboards and piece lists, but an accumulator belongs to one board only
+    *into = *from;
+    into->nnue = NULL;
+}
+
+/** @fn void Board_clone(Board_t *into, Board_t from)
+ * @brief By value variant of Board_clone_p
+ */
 void Board_clone(Board_t *into, Board_t from) {
-    for(ui8 r = 0; r < 8; r++) for(ui8 f = 0; f < 8; f++) into->content[f][r] = from.content[f][r];
-    into->turn = from.turn;
-    into->META_PASSANT_FILE = from.META_PASSANT_FILE;
-    into->META_CASTLE_H = from.META_CASTLE_H;
-    into->win = from.win;
-    into->META_CASTLE_A = from.META_CASTLE_A;
-    into->CB_ALLOW_DEFAULT_SPM = from.CB_ALLOW_DEFAULT_SPM;
-    into->turn_nr = from.turn_nr;
+    Board_clone_p(into, &from);
 }
 
 /** @fn ui8 Tool_Expression_Match(char *literal, char *match)
@@ -769,14 +876,44 @@ ui8 Tool_Expression_Match(char *literal, const char *match) {
 	return 0;
 }
 
-/** @fn ui8 Board_translate_expression(Board_t board, BoardMove_t *move, char *literal)
+/** @fn static ui8 Board_match_move(const Board_t *board, BoardMove_t *move, ui8 piece, ui8 from_file, ui8 to_file, ui8 to_rank, ui8 special)
+ * @brief Looks up the single legal move of a piece that matches the given fields, 8 matches any from_file or to_rank
+ * @param board Board to be checked
+ * @param move Pointer to move struct, set on a unique match
+ * @param piece Moving piece including color mask
+ * @returns legal code of the move || 0 - no match || 4 - multiple matches
+ */
+static ui8 Board_match_move(const Board_t *board, BoardMove_t *move, ui8 piece, ui8 from_file, ui8 to_file, ui8 to_rank, ui8 special) {
+    BoardMoveList_t list;
+    ui8 found = 0;
+
+    Board_generate_piece_moves(board, &list, CB_PIECE_TYPE(piece));
+    for(__UINT16_TYPE__ i = 0; i < list.count; i++) {
+        BoardMove_t *m = &list.moves[i];
+        if(board->content[m->from_file][m->from_rank] != piece)
+            continue;
+        if((from_file != 8 && m->from_file != from_file) || m->to_file != to_file ||
+            (to_rank != 8 && m->to_rank != to_rank) || m->special != special)
+            continue;
+
+        //Multiple pieces can perform this move!
+        if(found)
+            return 4;
+        found = 1;
+        *move = *m;
+    }
+
+    return found ? move->code : 0;
+}
+
+/** @fn ui8 Board_translate_expression_p(const Board_t *board, BoardMove_t *move, char literal[])
  * @brief String expression will be translated to move struct, validity of move will be checked
  * @param board Board to be checked
  * @param move Pointer to move struct
  * @param literal Expression
  * @returns 1 - is legal move || 0 - is not || 2 - capture || 3 - piece error || 4 - general expression error
  */
-ui8 Board_translate_expression(Board_t board, BoardMove_t *move, char literal[]) {
+ui8 Board_translate_expression_p(const Board_t *board, BoardMove_t *move, char literal[]) {
 
 	//Caps-up literal
 	long ix = 0;
@@ -791,52 +928,36 @@ ui8 Board_translate_expression(Board_t board, BoardMove_t *move, char literal[])
 	//e.g. A6 || E4
 	if(Tool_Expression_Match(literal, "|_") || Tool_Expression_Match(literal, "|_=@")) {
         ui8 file = literal[0] - 'A';
-        ui8 rank = 0;
-        ui8 found = 0;
-        //Get pawn rank
-		for(ix = 0; ix < 8; ix++) {
-            if(((Board_color_field(board, file, ix) == 1 && board.turn == CB_TURN_WHITE) ||
-                (Board_color_field(board, file, ix) == 2 && board.turn == CB_TURN_BLACK)) &&
-                ((board.content[file][ix] & ~(CB_WHITE_MASK | CB_BLACK_MASK)) == CB_PAWN)) {
-                if(found)
-                    return 4;
-                else {
-                    found = 1;
-                    rank = ix;
-                }
-            }
-        }
+        ui8 pawn = CB_PAWN | ((board->turn == CB_TURN_WHITE) ? CB_WHITE_MASK : CB_BLACK_MASK);
+
         //End reach
-        if(!found) return 3;
+        if(!(CB_BB_PIECE(board, board->turn, CB_PAWN) & (0x0101010101010101ull << file))) return 3;
 
-        move->from_file = file;
-        move->from_rank = rank;
-        move->to_file = file;
-        move->to_rank = literal[1] - '1'; 
+        ui8 to_file = file;
+        ui8 to_rank = literal[1] - '1';
 
         //Promotion process
         if(Tool_Expression_Match(literal, "|_=@")) {
-            move->to_rank = (Board_color_field(board, move->from_file, move->from_rank) == 1) ? 0 : 7;
+            to_rank = (board->turn == CB_TURN_WHITE) ? 0 : 7;
             switch(literal[3]) {
                 case 'R':
-                    move->to_file = 0;
+                    to_file = 0;
                 break;
                 case 'N':
-                    move->to_file = 1;
+                    to_file = 1;
                 break;
                 case 'B':
-                    move->to_file = 2;
+                    to_file = 2;
                 break;
                 case 'Q':
-                    move->to_file = 3;
+                    to_file = 3;
                 break;
                 default:
                     return 4;
             }
         }
-        move->special = 0;
 
-        return Board_legal_move(board, *move);
+        return Board_match_move(board, move, pawn, file, to_file, to_rank, 0);
 	}
 
 	//Move Pawn forward (incl. promotion), specified
@@ -848,14 +969,14 @@ ui8 Board_translate_expression(Board_t board, BoardMove_t *move, char literal[])
         move->to_rank = literal[3]-'1';
 
         //check for pawn and correct color at from
-        if(!(((Board_color_field(board, move->from_file, move->from_rank) == 1 && board.turn == CB_TURN_WHITE) ||
-            (Board_color_field(board, move->from_file, move->from_rank) == 2 && board.turn == CB_TURN_BLACK)) &&
-            ((board.content[move->from_file][move->from_rank] & ~(CB_WHITE_MASK | CB_BLACK_MASK)) == CB_PAWN)))
+        if(!(((Board_color_field_p(board, move->from_file, move->from_rank) == 1 && board->turn == CB_TURN_WHITE) ||
+            (Board_color_field_p(board, move->from_file, move->from_rank) == 2 && board->turn == CB_TURN_BLACK)) &&
+            ((board->content[move->from_file][move->from_rank] & ~(CB_WHITE_MASK | CB_BLACK_MASK)) == CB_PAWN)))
             return 3;
 
         //Promotion process
         if(Tool_Expression_Match(literal, "|_|_=@")) {
-            move->to_rank = (Board_color_field(board, move->from_file, move->from_rank) == 1) ? 0 : 7;
+            move->to_rank = (Board_color_field_p(board, move->from_file, move->from_rank) == 1) ? 0 : 7;
             switch(literal[5]) {
                 case 'R':
                     move->to_file = 0;
@@ -875,66 +996,47 @@ ui8 Board_translate_expression(Board_t board, BoardMove_t *move, char literal[])
         }
         move->special = 0;
 
-        return Board_legal_move(board, *move);
+        return Board_legal_move_p(board, *move);
 	}
 
 	//Capture with Pawn, generalized, check all pieces on file
 	//e.g. ExD || AxB
 	else if(Tool_Expression_Match(literal, "|X|") || Tool_Expression_Match(literal, "|X|=@")) {
         ui8 file = literal[0] - 'A';
-        ui8 rank = 0;
-        ui8 found = 0;
-        //Get pawn rank
-		for(ix = 0; ix < 8; ix++) {
-            if(((Board_color_field(board, file, ix) == 1 && board.turn == CB_TURN_WHITE) ||
-                (Board_color_field(board, file, ix) == 2 && board.turn == CB_TURN_BLACK)) &&
-                ((board.content[file][ix] & ~(CB_WHITE_MASK | CB_BLACK_MASK)) == CB_PAWN)) {
-                if(found)
-                    return 4;
-                else {
-                    found = 1;
-                    rank = ix;
-                }
-            }
-        }
-        //End reach
-        if(!found) return 3;
+        ui8 pawn = CB_PAWN | ((board->turn == CB_TURN_WHITE) ? CB_WHITE_MASK : CB_BLACK_MASK);
 
-        //Determine rank direction
-        signed short direction = (Board_color_field(board, file, rank) == 1) ? 1 : -1;
+        //End reach
+        if(!(CB_BB_PIECE(board, board->turn, CB_PAWN) & (0x0101010101010101ull << file))) return 3;
 
-        move->from_file = file;
-        move->from_rank = rank;
-        move->to_file = literal[2] - 'A';
-        move->to_rank = rank + direction;
+        ui8 to_file = literal[2] - 'A';
+        ui8 to_rank = 8;
+        ui8 special = 0;
 
         //Promotion process
         if(Tool_Expression_Match(literal, "|X|=@")) {
-            ui8 pf = move->to_file;
-            move->to_rank = (Board_color_field(board, move->from_file, move->from_rank) == 1) ? 0 : 7;
+            special = (file < to_file) ? 1 : 2;
+            to_rank = (board->turn == CB_TURN_WHITE) ? 0 : 7;
             switch(literal[4]) {
                 case 'R':
-                    move->to_file = 0;
+                    to_file = 0;
                 break;
                 case 'N':
-                    move->to_file = 1;
+                    to_file = 1;
                 break;
                 case 'B':
-                    move->to_file = 2;
+                    to_file = 2;
                 break;
                 case 'Q':
-                    move->to_file = 3;
+                    to_file = 3;
                 break;
                 default:
                     return 4;
             }
-
-            if(Board_legal_move(board, *move))
-                move->special = (move->from_file < pf) ? 1 : 2;
         }
+        //Sidewards only
+        else if(to_file == file) return 0;
 
-        return Board_legal_move(board, *move);
-		//TODO
+        return Board_match_move(board, move, pawn, file, to_file, to_rank, special);
 	}
 
 	//Capture with Pawn, specified
@@ -944,19 +1046,19 @@ ui8 Board_translate_expression(Board_t board, BoardMove_t *move, char literal[])
         move->from_rank = literal[1]-'1';
         move->to_file = literal[3]-'A';
 
-        signed short direction = (Board_color_field(board,  move->from_file, move->from_rank) == 1) ? 1 : -1;
+        signed short direction = (Board_color_field_p(board,  move->from_file, move->from_rank) == 1) ? 1 : -1;
         move->to_rank = move->from_rank + direction;
 
         //check for pawn and correct color at from
-        if(!(((Board_color_field(board, move->from_file, move->from_rank) == 1 && board.turn == CB_TURN_WHITE) ||
-            (Board_color_field(board, move->from_file, move->from_rank) == 2 && board.turn == CB_TURN_BLACK)) &&
-            ((board.content[move->from_file][move->from_rank] & ~(CB_WHITE_MASK | CB_BLACK_MASK)) == CB_PAWN)))
+        if(!(((Board_color_field_p(board, move->from_file, move->from_rank) == 1 && board->turn == CB_TURN_WHITE) ||
+            (Board_color_field_p(board, move->from_file, move->from_rank) == 2 && board->turn == CB_TURN_BLACK)) &&
+            ((board->content[move->from_file][move->from_rank] & ~(CB_WHITE_MASK | CB_BLACK_MASK)) == CB_PAWN)))
             return 3;
 
         //Promotion process
         if(Tool_Expression_Match(literal, "|_X|=@")) {
             ui8 pf = move->to_file;
-            move->to_rank = (Board_color_field(board, move->from_file, move->from_rank) == 1) ? 0 : 7;
+            move->to_rank = (Board_color_field_p(board, move->from_file, move->from_rank) == 1) ? 0 : 7;
             switch(literal[5]) {
                 case 'R':
                     move->to_file = 0;
@@ -974,11 +1076,10 @@ ui8 Board_translate_expression(Board_t board, BoardMove_t *move, char literal[])
                     return 4;
             }
 
-            if(Board_legal_move(board, *move))
-                move->special = (move->from_file < pf) ? 1 : 2;
+            move->special = (move->from_file < pf) ? 1 : 2;
         }
 
-        return Board_legal_move(board, *move);
+        return Board_legal_move_p(board, *move);
 	}
 
 	//Move with Piece, generalized, check all specific pieces on board
@@ -996,7 +1097,6 @@ ui8 Board_translate_expression(Board_t board, BoardMove_t *move, char literal[])
             expect_capture = 1;
         }
 
-        ui8 valid = 0;
         ui8 piece;
 
         // Get piece code
@@ -1009,38 +1109,15 @@ ui8 Board_translate_expression(Board_t board, BoardMove_t *move, char literal[])
             default: return 4;
         }
         // Apply color mask
-        piece |= (board.turn == CB_TURN_WHITE) ? CB_WHITE_MASK : CB_BLACK_MASK;
+        piece |= (board->turn == CB_TURN_WHITE) ? CB_WHITE_MASK : CB_BLACK_MASK;
 
-        move->to_file = tfc - 'A';
-        move->to_rank = trc - '1';
+        // Look the move up in the legal moves, if multiple of the same type of piece can perform the same move, return 4
+        ui8 ret = Board_match_move(board, move, piece, 8, tfc - 'A', trc - '1', 0);
 
-        ui8 file = 8;
-        ui8 rank = 8;
-
-        // Iterate all movements, if multiple of the same type of piece can perform the same move, return 4
-        for(ui8 r = 0; r < 8; r++) for(ui8 f = 0; f < 8; f++) {
-            if(board.content[f][r] == piece) {
-                move->from_file = f;
-                move->from_rank = r;
-
-                if(Board_legal_move(board, *move)) {
-                    //Multiple pieces can perform this move!
-                    if(valid) return 4;
-                    valid = 1;
-                    file = f;
-                    rank = r;
-                }
-            }
-        }
-        
         //Check if pieces were able to perform this
-        if(file == 8) return 3;
-
-        //Post set and if expecting capture
-        move->from_file = file;
-        move->from_rank = rank;
+        if(ret == 0) return 3;
 
-        ui8 ret = Board_legal_move(board, *move);
+        //If expecting capture
         if(expect_capture && ret != 2)
             return 4;
         
@@ -1075,7 +1152,7 @@ ui8 Board_translate_expression(Board_t board, BoardMove_t *move, char literal[])
             default: return 4;
         }
         // Apply color mask
-        piece |= (board.turn == CB_TURN_WHITE) ? CB_WHITE_MASK : CB_BLACK_MASK;
+        piece |= (board->turn == CB_TURN_WHITE) ? CB_WHITE_MASK : CB_BLACK_MASK;
 
         //Check if piece is correct
         move->from_file = literal[1] - 'A';
@@ -1083,11 +1160,11 @@ ui8 Board_translate_expression(Board_t board, BoardMove_t *move, char literal[])
         move->to_file = tfc - 'A';
         move->to_rank = trc - '1';
 
-        if(board.content[move->from_file][move->from_rank] != piece)
+        if(board->content[move->from_file][move->from_rank] != piece)
             return 3;
 
         //if expecting capture
-        ui8 ret = Board_legal_move(board, *move);
+        ui8 ret = Board_legal_move_p(board, *move);
         if(expect_capture && ret != 2)
             return 4;
         
@@ -1100,10 +1177,10 @@ ui8 Board_translate_expression(Board_t board, BoardMove_t *move, char literal[])
         literal[0] = 'K';
         literal[1] = 'H';
         literal[2] = '8';
-        if(board.turn == CB_TURN_WHITE)
+        if(board->turn == CB_TURN_WHITE)
             literal[2] = '1';
 
-        return Board_translate_expression(board, move, literal);
+        return Board_translate_expression_p(board, move, literal);
     }
 
     //Castle queen's side
@@ -1113,11 +1190,87 @@ ui8 Board_translate_expression(Board_t board, BoardMove_t *move, char literal[])
         literal[1] = 'A';
         literal[2] = '8';
         literal[3] = 0;
-        if(board.turn == CB_TURN_WHITE)
+        if(board->turn == CB_TURN_WHITE)
             literal[2] = '1';
 
-        return Board_translate_expression(board, move, literal);
+        return Board_translate_expression_p(board, move, literal);
     }
 
     return 4;
 }
+
+/** @fn ui8 Board_translate_expression(Board_t board, BoardMove_t *move, char literal[])
+ * @brief By value variant of Board_translate_expression_p
+ */
+ui8 Board_translate_expression(Board_t board, BoardMove_t *move, char literal[]) {
+    return Board_translate_expression_p(&board, move, literal);
+}
+
+/** @fn void Board_move_to_string(const Board_t *board, BoardMove_t move, char *out)
+ * @brief Writes a move in coordinate notation, castling as the king's step and promotions with a lowercase piece (e.g. e1g1, e7d8q)
+ * @param board Board the move is played on, required to resolve promotions and castling
+ * @param move Move, code as returned by Board_legal_move
+ * @param out At least 6 characters
+ * @returns none
+ */
+void Board_move_to_string(const Board_t *board, BoardMove_t move, char *out) {
+    ui8 to_file = move.to_file;
+    ui8 to_rank = move.to_rank;
+    char promotion = 0;
+
+    //Castling, the king moves onto its rook
+    if(move.code == 6 || move.code == 7)
+        to_file = (move.code == 6) ? CB_FILE_C : CB_FILE_G;
+
+    //Promotion, the piece is encoded in to_file and the side in special
+    if(move.code > 7 && move.code < 12) {
+        const char pieces[4] = {'r', 'n', 'b', 'q'};
+        promotion = pieces[move.to_file];
+        to_file = move.from_file + ((move.special == 1) ? 1 : 0) - ((move.special == 2) ? 1 : 0);
+        to_rank = (Board_color_field_p(board, move.from_file, move.from_rank) == 1) ? 7 : 0;
+    }
+
+    out[0] = 'a' + move.from_file;
+    out[1] = '1' + move.from_rank;
+    out[2] = 'a' + to_file;
+    out[3] = '1' + to_rank;
+    out[4] = promotion;
+    out[5] = 0;
+}
+
+/** @fn ui8 Board_move_target(const Board_t *board, BoardMove_t move)
+ * @brief Gets the field a move's piece ends on, resolving the promotion and castling encodings
+ * @param board Board the move is played on
+ * @param move Move, code as returned by Board_legal_move
+ * @returns Square index (CB_SQUARE)
+ */
+ui8 Board_move_target(const Board_t *board, BoardMove_t move) {
+    //Castling, the king moves onto its rook
+    if(move.code == 6 || move.code == 7)
+        return CB_SQUARE((move.code == 6) ? CB_FILE_C : CB_FILE_G, move.to_rank);
+
+    //Promotion, the side is encoded in special
+    if(move.code > 7 && move.code < 12)
+        return CB_SQUARE(move.from_file + ((move.special == 1) ? 1 : 0) - ((move.special == 2) ? 1 : 0),
+            (Board_color_field_p(board, move.from_file, move.from_rank) == 1) ? 7 : 0);
+
+    return CB_SQUARE(move.to_file, move.to_rank);
+}
+
+/** @fn ui8 Board_move_victim(const Board_t *board, BoardMove_t move)
+ * @brief Gets the piece type a move captures, from its Board_legal_move code
+ * @param board Board the move is played on
+ * @param move Move, code as returned by Board_legal_move
+ * @returns Piece type without color mask || CB_EMPTY - no capture
+ */
+ui8 Board_move_victim(const Board_t *board, BoardMove_t move) {
+    switch(move.code) {
+        case 2: return CB_PIECE_TYPE(board->content[move.to_file][move.to_rank]);
+        case 5: return CB_PAWN;
+        case 8: case 9: case 10: case 11: {
+            ui8 target = Board_move_target(board, move);
+            return CB_PIECE_TYPE(board->content[CB_SQUARE_FILE(target)][CB_SQUARE_RANK(target)]);
+        }
+        default: return CB_EMPTY;
+    }
+}
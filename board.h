@@ -5,6 +5,9 @@
  ****************************************************
  * Responsibilities:                                *
  *  - board                                         *
+ *  - reentrant: no global state besides the        *
+ *    attack tables, which are built once and       *
+ *    read-only afterwards                          *
  *                                                  *
  * Requires:                                        *
  *  - ...                                           *
@@ -44,14 +47,45 @@
     #define CB_TURN_FIRST (0)
     #define CB_TURN_WHITE (0)
     #define CB_TURN_BLACK (1)
+    #define CB_TURN_COLOR(board) (((board)->turn == CB_TURN_WHITE) ? 1 : 2)      /* Color in turn, 1 = white, 2 = black */
 
     #define CB_SET_CONTENT(color, piece, file, rank) ->content CB_INDEX(file, rank) = ((CB_ ## piece) | (CB_ ## color ## _MASK))    /* e.g. CB_SET_CONTENT(WHITE, ROOK, A, 1) */
 
+    /**** BITBOARD HELPERS ****/
+    #define CB_SQUARE(file, rank) ((file) + ((rank) << 3))                          /* Bitboard square index, A1 = 0, H1 = 7, H8 = 63 */
+    #define CB_SQUARE_FILE(square) ((square) & 7)                                   /* Square index to file */
+    #define CB_SQUARE_RANK(square) ((square) >> 3)                                  /* Square index to rank */
+    #define CB_BIT(square) (((ui64) 1) << (square))                                 /* Single square bitboard */
+    #define CB_NO_SQUARE (64)                                                       /* Square index for "none" */
+    #define CB_FILE_BB(file) (((ui64) 0x0101010101010101) << (file))                /* All squares of a file */
+    #define CB_PIECE_TYPE(piece) ((piece) & ~(CB_WHITE_MASK | CB_BLACK_MASK))       /* Strips the color of a piece */
+    #define CB_PIECE_COLOR(piece) (((piece) & CB_WHITE_MASK) ? 0 : 1)               /* Bitboard color index, 0 = white, 1 = black */
+    #define CB_POPCOUNT(bb) ((ui8) __builtin_popcountll(bb))                        /* Number of set squares */
+    #define CB_BB_COLOR(board, color) ((board)->bitboards[(color)][CB_EMPTY])       /* All pieces of a color (0 = white, 1 = black) */
+    #define CB_BB_PIECE(board, color, piece) ((board)->bitboards[(color)][(piece)]) /* All pieces of a color and type */
+    #define CB_BB_OCCUPIED(board) (CB_BB_COLOR(board, 0) | CB_BB_COLOR(board, 1))   /* All pieces */
+
+    /**** ATTACK LOOKUPS (board_bitboard.c, require Board_init_tables) ****/
+    #define CB_KNIGHT_ATTACKS(square) (Board_knight_table[(square)])                                /* Knight attacks from a square */
+    #define CB_KING_ATTACKS(square) (Board_king_table[(square)])                                    /* King attacks from a square */
+    #define CB_PAWN_ATTACKS(color, square) (Board_pawn_table[(color)][(square)])                    /* Pawn capture attacks, color 0 = white, 1 = black */
+    #define CB_MAGIC_ATTACKS(m, occupied) ((m)->attacks[(((occupied) & (m)->mask) * (m)->magic) >> (m)->shift])
+    #define CB_ROOK_ATTACKS(square, occupied) CB_MAGIC_ATTACKS(&Board_rook_magics[(square)], occupied)       /* Rook attacks through occupancy */
+    #define CB_BISHOP_ATTACKS(square, occupied) CB_MAGIC_ATTACKS(&Board_bishop_magics[(square)], occupied)   /* Bishop attacks through occupancy */
+    #define CB_QUEEN_ATTACKS(square, occupied) (CB_ROOK_ATTACKS(square, occupied) | CB_BISHOP_ATTACKS(square, occupied))
+
     /***** META *****/
     #define CB_CURRENT_FILE_HEADER "CHEDS" "\5" "1.0.2"
 
     /***** GLOBAL TYPES, VARS *****/
     typedef char ui8;                          /* uint8_t */
+    typedef __UINT64_TYPE__ ui64;              /* uint64_t */
+
+    #define CB_NNUE_HIDDEN (256)    /* Accumulator width of a network, per side */
+
+    typedef struct BoardAccumulator_t_s {
+        short values[2][CB_NNUE_HIDDEN];    /* First network layer before activation, from white's and black's view */
+    } BoardAccumulator_t;                   /* Network accumulator, see board_nnue.c */
 
     typedef struct Board_t_s {
         ui8 content[8][8];          /* Raw content */
@@ -62,6 +96,17 @@
         ui8 META_CASTLE_H;          /* Enable flag for Castling King's side */
         ui8 META_PASSANT_FILE;      /* En Passant file, exact pawn is easily determined, the pawn remains on the same file and the flag applies for the person who now isn't in turn */
         __UINT16_TYPE__ turn_nr;    /* The turn number */
+        ui64 bitboards[2][7];       /* Bitboards by color (0 = white, 1 = black) and piece type, CB_EMPTY holds all pieces of that color, mirrors content */
+        ui8 king_square[2];         /* King square per color, CB_NO_SQUARE if there is none */
+        ui8 piece_count[2];         /* Number of pieces per color */
+        ui8 piece_list[2][64];      /* Squares of every piece per color, unordered */
+        ui8 piece_index[64];        /* Index of a square's piece within its piece list */
+        ui64 key;                   /* Zobrist key of placement, turn, castle flags and en passant file */
+        ui64 pawn_key;              /* Zobrist key of the pawns only, indexes the pawn table */
+        int psqt_mg;                /* Material and piece-square total, white minus black, middlegame tables */
+        int psqt_eg;                /* Same with the endgame tables */
+        ui8 phase;                  /* Sum of Board_phase_weights over all pieces, 24 in the starting position */
+        BoardAccumulator_t *nnue;   /* Accumulator kept up to date with the pieces || NULL - classical evaluation, see Board_nnue_attach */
     } Board_t;                      /* Board struct that stores pieces as indexes */
 
     typedef struct BoardMove_t_s {
@@ -69,9 +114,162 @@
         ui8 from_rank;
         ui8 to_file;
         ui8 to_rank;
-        ui8 special;                 /* 0 = none || 1 = capture minus file || 2 = capture plus file */
+        ui8 special;                 /* Promotion target: 0 = forward || 1 = capture plus file || 2 = capture minus file */
+        ui8 code;                    /* Board_legal_move result, filled in by Board_generate_moves */
     } BoardMove_t;
 
+    #define CB_MAX_MOVES (256)       /* Move list capacity, legal chess positions stay below 220 */
+    #define CB_IS_PROMOTION(code) ((code) > 7 && (code) < 12)  /* Board_legal_move codes 8 to 11 */
+    #define CB_PROMOTION_PIECE(code) ((code) - 6)                 /* Piece type of a promotion code, rook to queen */
+
+    typedef struct BoardMoveList_t_s {
+        BoardMove_t moves[CB_MAX_MOVES];
+        __UINT16_TYPE__ count;
+    } BoardMoveList_t;               /* List of legal moves of a position */
+
+    typedef struct BoardUndo_t_s {
+        BoardMove_t move;            /* Move as made, code holds its Board_legal_move result */
+        ui8 piece;                   /* Moved piece, before promotion */
+        ui8 captured;                /* Captured piece or CB_EMPTY */
+        ui8 captured_file;           /* Field of the captured piece, differs from the target on en passant */
+        ui8 captured_rank;
+        ui8 META_CASTLE_A;           /* Flags before the move */
+        ui8 META_CASTLE_H;
+        ui8 META_PASSANT_FILE;
+        ui8 win;
+        ui64 key;                    /* Zobrist key before the move */
+    } BoardUndo_t;                   /* Everything Board_unmake_move needs to take a move back */
+
+    typedef struct BoardUndoStack_t_s {
+        BoardUndo_t *records;        /* Caller-owned record storage */
+        __UINT16_TYPE__ size;        /* Records in use */
+        __UINT16_TYPE__ capacity;    /* Records available */
+    } BoardUndoStack_t;              /* Stack of undo records for walking a move tree in place */
+
+    #define CB_UNDO_STACK(storage) {.records = (storage), .size = 0, .capacity = sizeof(storage) / sizeof((storage)[0])}   /* e.g. BoardUndo_t s[64]; BoardUndoStack_t stack = CB_UNDO_STACK(s); */
+
+    typedef struct BoardMagic_t_s {
+        ui64 mask;                   /* Squares whose occupancy matters */
+        ui64 magic;                  /* Multiplier mapping every mask subset to a unique index */
+        ui64 *attacks;               /* Attack table of this square */
+        ui8 shift;                   /* 64 - number of mask squares */
+    } BoardMagic_t;                  /* Magic bitboard lookup of one square */
+
+    #define CB_PERFT_MAX_DEPTH (32)  /* Deepest perft, sizes the undo stack */
+    #define CB_PERFT_CASES (6)       /* Number of built-in perft reference positions */
+
+    typedef struct BoardPerftCase_t_s {
+        const char *fen;             /* Position */
+        ui8 depth;                   /* Plies */
+        ui64 nodes;                  /* Expected leaf count */
+    } BoardPerftCase_t;              /* Perft reference position */
+
+    typedef struct BoardPerftEntry_t_s {
+        ui64 lock;                   /* Key ^ data, rejects entries torn by concurrent writes */
+        ui64 data;                   /* Leaf count in the low 56 bits, depth in the high 8 */
+    } BoardPerftEntry_t;
+
+    typedef struct BoardPerftCache_t_s {
+        BoardPerftEntry_t *entries;  /* Indexed by the low bits of Board_t.key */
+        __SIZE_TYPE__ size;          /* Number of entries, power of two */
+        ui64 hits;                   /* Lookups answered, summed over all calls */
+        ui64 misses;                 /* Lookups not answered */
+    } BoardPerftCache_t;             /* Perft transposition cache, (key, depth) -> leaf count */
+
+    #define CB_MAX_PLY (64)          /* Deepest search path */
+    #define CB_MAX_THREADS (256)     /* Most search threads, more are clamped */
+    #define CB_SCORE_MATE (30000)    /* Mate score, minus the plies to mate */
+    #define CB_SCORE_INF (32000)     /* Beyond any score */
+
+    typedef struct BoardSearchResult_t_s {
+        BoardMove_t best;            /* Best move, first move of pv */
+        int score;                   /* Centipawns from the view of the side in turn, mates as +-(CB_SCORE_MATE - plies) */
+        ui8 depth;                   /* Depth of the last completed iteration */
+        ui64 nodes;                  /* Nodes searched */
+        BoardMove_t pv[CB_MAX_PLY];  /* Principal variation */
+        ui8 pv_length;
+        ui64 time;                   /* Milliseconds since the search started */
+    } BoardSearchResult_t;           /* Outcome of Board_search */
+
+    #define CB_BOUND_LOWER (1)       /* Score is at least the stored one */
+    #define CB_BOUND_UPPER (2)       /* Score is at most the stored one */
+    #define CB_BOUND_EXACT (3)
+
+    typedef struct BoardTTEntry_t_s {
+        ui64 lock;                   /* Key ^ data, rejects entries torn by concurrent writes */
+        ui64 data;                   /* Packed move, score, depth and bound, see board_tt.c */
+    } BoardTTEntry_t;
+
+    #define CB_TT_BUCKET (4)         /* Entries per bucket, one cache line */
+
+    typedef struct BoardTTBucket_t_s {
+        BoardTTEntry_t entries[CB_TT_BUCKET];
+    } BoardTTBucket_t;               /* Entries sharing one index */
+
+    typedef struct BoardTT_t_s {
+        BoardTTBucket_t *buckets;    /* Indexed by the low bits of Board_t.key */
+        __SIZE_TYPE__ size;          /* Number of buckets, power of two */
+        ui8 generation;              /* Age stamped on new entries, advanced by every search */
+    } BoardTT_t;                     /* Transposition table, lock-free, shared by search threads */
+
+    typedef struct BoardTTData_t_s {
+        BoardMove_t move;            /* Best move, code 0 if none */
+        int score;
+        ui8 depth;
+        ui8 bound;                   /* CB_BOUND_* */
+    } BoardTTData_t;                 /* Unpacked table entry */
+
+    typedef struct BoardPawnEntry_t_s {
+        ui64 key;                    /* Board_t.pawn_key of the structure */
+        short mg;                    /* Doubled, isolated and passed pawns, white minus black, middlegame weights */
+        short eg;                    /* Same with endgame weights */
+        short shield[2][2];          /* Pawn shield per color (0 = white) and wing (0 = queen's, 1 = king's) */
+    } BoardPawnEntry_t;              /* Cached pawn structure terms */
+
+    typedef struct BoardPawnTable_t_s {
+        BoardPawnEntry_t *entries;   /* Indexed by the low bits of Board_t.pawn_key */
+        __SIZE_TYPE__ size;          /* Number of entries, power of two */
+        ui64 hits;                   /* Lookups answered */
+        ui64 misses;                 /* Structures evaluated and stored */
+    } BoardPawnTable_t;              /* Pawn structure cache, owned by one thread */
+
+    typedef struct BoardEvalCache_t_s {
+        ui64 *entries;               /* Key and score in one word, see board_eval_cache.c */
+        __SIZE_TYPE__ size;          /* Number of entries, power of two */
+        ui64 hits;                   /* Lookups answered, summed over all searches */
+        ui64 misses;                 /* Positions evaluated and stored */
+    } BoardEvalCache_t;              /* Evaluation cache, key -> static evaluation, lock-free, shared by search threads */
+
+    #define CB_PRUNE_NULL (1)        /* Null move pruning */
+    #define CB_PRUNE_LMR (2)         /* Late move reductions */
+    #define CB_PRUNE_FUTILITY (4)    /* Futility pruning of quiet moves near the leaves */
+    #define CB_PRUNE_REVERSE (8)     /* Reverse futility pruning, static cutoffs near the leaves */
+
+    typedef struct BoardSearchLimits_t_s {
+        ui8 depth;                   /* Deepest iteration, 0 or beyond CB_MAX_PLY - 1 = CB_MAX_PLY - 1 */
+        ui64 nodes;                  /* Node budget of all threads together, 0 = none */
+        unsigned int threads;        /* Search threads, 0 or 1 = single threaded, at most CB_MAX_THREADS */
+        BoardTT_t *tt;               /* Table, kept across searches by the caller || NULL - temporary table */
+        BoardEvalCache_t *evals;     /* Evaluation cache, kept across searches by the caller || NULL - none */
+        ui8 disabled;                /* CB_PRUNE_* techniques switched off, 0 = all on */
+        ui64 time;                   /* Milliseconds left on the clock of the side in turn, 0 = no clock */
+        ui64 increment;              /* Milliseconds added to the clock per move */
+        ui8 moves_to_go;             /* Moves until the clock is refilled, 0 = the rest of the game */
+        ui64 deadline;               /* Milliseconds the move has to be found in, enforced by a watchdog, 0 = none */
+        void (*info)(const Board_t *, const BoardSearchResult_t *);  /* Called after every completed iteration, may be NULL */
+    } BoardSearchLimits_t;           /* Budget of Board_search */
+
+    typedef struct BoardTimer_t_s {
+        ui64 start;                  /* Board_time_now when the search started */
+        ui64 soft;                   /* Milliseconds after which no iteration is started, scaled by stability, 0 = no limit */
+        ui64 hard;                   /* Milliseconds after which the search is stopped, 0 = no limit */
+        ui8 stable;                  /* Iterations in a row the best move stayed the same */
+        BoardMove_t last_best;       /* Best move of the last iteration */
+        ui64 iteration_start;        /* Board_time_now when the current iteration started */
+        ui64 iteration;              /* Milliseconds of the last iteration */
+        ui64 last_iteration;         /* ... and of the one before */
+    } BoardTimer_t;                  /* Time management of one search */
+
     //temporary
     // Dynamic list
     typedef struct dynl_s {
@@ -79,24 +277,151 @@
         struct dynl_s *n;
     } dynl_t;
 
+    /***** GLOBAL TABLES (board_bitboard.c) *****/
+    extern ui64 Board_knight_table[64];
+    extern ui64 Board_king_table[64];
+    extern ui64 Board_pawn_table[2][64];
+    extern BoardMagic_t Board_rook_magics[64];
+    extern BoardMagic_t Board_bishop_magics[64];
+    extern ui64 Board_zobrist_piece[2][7][64];
+    extern ui64 Board_zobrist_castle[16];
+    extern ui64 Board_zobrist_passant[16];
+    extern ui64 Board_zobrist_turn;
+    extern const BoardPerftCase_t Board_perft_cases[CB_PERFT_CASES];
+
+    #define CB_PSQT(stage, piece, square) (Board_piece_values[CB_PIECE_TYPE(piece)] + \
+        Board_psqt[(stage)][CB_PIECE_TYPE(piece)][(square) ^ (CB_PIECE_COLOR(piece) ? 0 : 56)])    /* Value of a piece with color mask on a square, stage 0 = middlegame, 1 = endgame */
+    #define CB_ZOBRIST_PIECE(piece, square) (Board_zobrist_piece[CB_PIECE_COLOR(piece)][CB_PIECE_TYPE(piece)][(square)])    /* Key of a piece with color mask on a square */
+    #define CB_ZOBRIST_STATE(board) (Board_zobrist_castle[(((board)->META_CASTLE_A & 3) << 2) | ((board)->META_CASTLE_H & 3)] ^ \
+        Board_zobrist_passant[(board)->META_PASSANT_FILE & 15] ^ (((board)->turn == CB_TURN_BLACK) ? Board_zobrist_turn : 0))  /* Key of everything but the placement */
+
     /***** GLOBAL METHOD DECLARATIONS *****/
     void Board_init_default(Board_t *);                                 /* Default board placement initializer */
     void Board_init(Board_t *);                                         /* This gets called in main though */
-    ui8 Board_legal_move(Board_t, BoardMove_t);                         /* Checks if legal move */
-    ui8 Board_color_field(Board_t, ui8, ui8);                           /* Gets a field's color */
-    ui8 Board_defended_field(Board_t, ui8, ui8);                        /* Checks if a field is defended by both colors */
+    ui8 Board_legal_move_p(const Board_t *, BoardMove_t);               /* Checks if legal move */
+    ui8 Board_defended_field_p(const Board_t *, ui8, ui8);              /* Checks if a field is defended by both colors */
     ui8 Tool_Expression_Match(char *, const char *);                    /* Arithmetic chess "regex" matcher */
     ui8 Tool_Match(char *, const char *, long);                         /* String matching tool, does not use expression format */
-    ui8 Board_translate_expression(Board_t, BoardMove_t *, char *);     /* Translate expression to move */
+    ui8 Board_translate_expression_p(const Board_t *, BoardMove_t *, char *);   /* Translate expression to move */
+    void Board_move_to_string(const Board_t *, BoardMove_t, char *);    /* Move in coordinate notation, e.g. e7e8q */
+    ui8 Board_move_target(const Board_t *, BoardMove_t);                /* Field a move ends on */
+    ui8 Board_move_victim(const Board_t *, BoardMove_t);                /* Piece type a move captures */
     ui8 Board_apply(Board_t *, BoardMove_t);                            /* Applies move to board */
-    ui8 Board_in_check(Board_t, ui8);                                   /* Checks of the color is in check */
-    void Board_clone(Board_t *, Board_t);                               /* Clones */
-    ui8 Board_in_mate(Board_t, ui8);                                    /* Evaluates if the game is lost */
-    ui8 Board_in_stale(Board_t, ui8);                                   /* Evaluates if the game is in draw */
+    ui8 Board_in_check_p(const Board_t *, ui8);                         /* Checks of the color is in check */
+    void Board_clone_p(Board_t *, const Board_t *);                     /* Clones */
+    void Board_set_field(Board_t *, ui8, ui8, ui8);                     /* Sets a field's content and keeps the derived state in sync */
+    void Board_sync(Board_t *);                                         /* Rebuilds bitboards, piece lists, king squares and key from content */
+    ui64 Board_compute_key(const Board_t *);                            /* Computes the zobrist key from scratch */
+    ui8 Board_in_mate_p(const Board_t *, ui8);                          /* Evaluates if the game is lost */
+    ui8 Board_in_stale_p(const Board_t *, ui8);                         /* Evaluates if the game is in draw */
+    ui8 Board_make_move(Board_t *, BoardMove_t, BoardUndoStack_t *);    /* Plays a validated move in place and pushes an undo record */
+    ui8 Board_make_null_move(Board_t *, BoardUndoStack_t *);            /* Passes the turn, for null move pruning */
+    void Board_unmake_move(Board_t *, BoardUndoStack_t *);              /* Takes back the latest made move */
+
+    /***** GLOBAL BY VALUE DECLARATIONS, wrappers around the _p variants *****/
+    ui8 Board_legal_move(Board_t, BoardMove_t);
+    ui8 Board_color_field(Board_t, ui8, ui8);
+    ui8 Board_defended_field(Board_t, ui8, ui8);
+    ui8 Board_translate_expression(Board_t, BoardMove_t *, char *);
+    ui8 Board_in_check(Board_t, ui8);
+    void Board_clone(Board_t *, Board_t);
+    ui8 Board_in_mate(Board_t, ui8);
+    ui8 Board_in_stale(Board_t, ui8);
+
+    /***** GLOBAL ATTACK TABLE DECLARATIONS *****/
+    void Board_init_tables(void);                                       /* Builds the attack lookup tables once */
+    ui64 Board_attackers_to(const Board_t *, ui8, ui64);                /* Gets all pieces attacking a square */
+
+    /***** GLOBAL MOVE GENERATION DECLARATIONS *****/
+    __UINT16_TYPE__ Board_generate_moves(const Board_t *, BoardMoveList_t *);   /* Generates all legal moves of the side in turn */
+    ui8 Board_has_legal_move(const Board_t *);                          /* Checks if the side in turn has any legal move */
+    ui8 Board_color_has_legal_move(const Board_t *, ui8);               /* Checks if a color has any legal move */
+    __UINT16_TYPE__ Board_generate_piece_moves(const Board_t *, BoardMoveList_t *, ui8);    /* Generates the legal moves of one piece type */
+    __UINT16_TYPE__ Board_generate_captures(const Board_t *, BoardMoveList_t *);    /* Generates captures and promotions of the side in turn */
+    __UINT16_TYPE__ Board_generate_quiets(const Board_t *, BoardMoveList_t *);      /* Generates the remaining moves of the side in turn */
+    ui8 Board_move_is_legal(const Board_t *, BoardMove_t *);            /* Checks a single move for the side in turn, fills in its code */
+
+    /***** GLOBAL PERFT DECLARATIONS *****/
+    ui64 Board_perft(const Board_t *, ui8);                             /* Counts the leaves of the legal move tree */
+    __UINT16_TYPE__ Board_perft_divide(const Board_t *, ui8, BoardMoveList_t *, ui64 *);   /* Perft per root move */
+    ui64 Board_perft_parallel(const Board_t *, ui8, unsigned int);      /* Perft on a number of threads */
+    ui64 Board_perft_cached(const Board_t *, ui8, unsigned int, BoardPerftCache_t *);  /* Perft on a number of threads with a transposition cache */
+    ui8 Board_perft_cache_init(BoardPerftCache_t *, __SIZE_TYPE__);     /* Allocates a perft cache of a number of megabytes */
+    void Board_perft_cache_free(BoardPerftCache_t *);                   /* Releases a perft cache */
+
+    /***** GLOBAL SEARCH DECLARATIONS *****/
+    extern const int Board_piece_values[7];
+    extern const short *const Board_psqt[2][7];
+    extern const ui8 Board_phase_weights[7];
+    int Board_evaluate(const Board_t *, BoardPawnTable_t *);            /* Static evaluation from the view of the side in turn */
+    ui8 Board_pawn_table_init(BoardPawnTable_t *, __SIZE_TYPE__);       /* Allocates a pawn table of a number of kilobytes */
+    void Board_pawn_table_free(BoardPawnTable_t *);                     /* Releases a pawn table */
+    int Board_see(const Board_t *, BoardMove_t);                        /* Material won or lost by the exchanges on a move's target */
+    ui8 Board_search(const Board_t *, const BoardSearchLimits_t *, BoardSearchResult_t *);  /* Finds the best move within the limits */
+
+    /***** GLOBAL EVALUATION CACHE DECLARATIONS *****/
+    ui8 Board_eval_cache_init(BoardEvalCache_t *, __SIZE_TYPE__);       /* Allocates a cache of a number of megabytes */
+    void Board_eval_cache_free(BoardEvalCache_t *);                     /* Releases a cache */
+    void Board_eval_cache_clear(BoardEvalCache_t *);                    /* Forgets every entry */
+    ui8 Board_eval_cache_probe(const BoardEvalCache_t *, ui64, int *);  /* Looks up a position's evaluation */
+    void Board_eval_cache_store(BoardEvalCache_t *, ui64, int);         /* Stores a position's evaluation */
+
+    /***** GLOBAL NNUE DECLARATIONS *****/
+    ui8 Board_nnue_load(const char *);                                  /* Loads a network file, before any search */
+    ui8 Board_nnue_ready(void);                                         /* Checks if a network is loaded */
+    ui8 Board_nnue_attach(Board_t *, BoardAccumulator_t *);             /* Evaluates a board with the network from now on */
+    void Board_nnue_reset(BoardAccumulator_t *);                        /* Accumulator of the empty board */
+    void Board_nnue_add(BoardAccumulator_t *, ui8, ui8);                /* Adds a piece on a square */
+    void Board_nnue_remove(BoardAccumulator_t *, ui8, ui8);             /* Removes a piece from a square */
+    int Board_nnue_evaluate(const Board_t *);                           /* Network evaluation from the view of the side in turn */
+
+    /***** GLOBAL TIME DECLARATIONS *****/
+    ui64 Board_time_now(void);                                          /* Monotonic clock in milliseconds */
+    void Board_time_init(BoardTimer_t *, const BoardSearchLimits_t *);  /* Starts a search's clock and sets its budgets */
+    ui64 Board_time_elapsed(const BoardTimer_t *);                      /* Milliseconds since the search started */
+    ui8 Board_time_iteration(BoardTimer_t *, BoardMove_t);              /* Checks if another iteration fits the budget */
+
+    /***** GLOBAL TRANSPOSITION TABLE DECLARATIONS *****/
+    ui8 Board_tt_init(BoardTT_t *, __SIZE_TYPE__);                      /* Allocates a table of a number of megabytes */
+    void Board_tt_free(BoardTT_t *);                                    /* Releases a table */
+    void Board_tt_clear(BoardTT_t *);                                   /* Forgets every entry */
+    void Board_tt_new_search(BoardTT_t *);                              /* Ages the entries of earlier searches */
+    ui8 Board_tt_probe(const BoardTT_t *, ui64, BoardTTData_t *);       /* Looks up a position */
+    void Board_tt_store(BoardTT_t *, ui64, BoardMove_t, int, ui8, ui8); /* Stores a search result */
 
     /***** GLOBAL FILE HANDLE DECLARATIONS *****/
     ui8 Board_load_from_string(Board_t *, char *);                      /* Load a board from cstring */
     ui8 Board_load_from_file(Board_t *, char *);                        /* Load a board from a path */
-    ui8 Board_save_to_file(Board_t, char *);                          /* Save board to a path */
+    ui8 Board_load_from_fen(Board_t *, const char *);                   /* Load a board from FEN */
+    ui8 Board_save_to_file_p(const Board_t *, char *);                  /* Save board to a path */
+    ui8 Board_save_to_file(Board_t, char *);                            /* By value wrapper */
+
+    /***** GLOBAL INLINE HELPERS *****/
+
+    /** @fn static inline void Board_tt_prefetch(const BoardTT_t *tt, ui64 key)
+     * @brief Starts loading the bucket of a position into the cache, called right after a move is made
+     * @param tt Table
+     * @param key Board_t.key of the new position
+     * @returns none
+     */
+    static inline void Board_tt_prefetch(const BoardTT_t *tt, ui64 key) {
+        __builtin_prefetch(&tt->buckets[key & (tt->size - 1)]);
+    }
+
+    /** @fn static inline ui8 Board_color_field_p(const Board_t *board, ui8 file, ui8 rank)
+     * @brief Gets a field's color, or 0 if empty. Inline, called on every square a legality check looks at
+     * @param board Board to be checked
+     * @param file File A-G (0-7 in index 1)
+     * @param rank Rank 1-8 (0-7 in index 2)
+     * @returns 0 - empty || 1 - white || 2 - black
+     */
+    static inline ui8 Board_color_field_p(const Board_t *board, ui8 file, ui8 rank) {
+        ui64 bit = CB_BIT(CB_SQUARE(file, rank));
+        if(CB_BB_COLOR(board, 0) & bit)
+            return 1;
+        else if(CB_BB_COLOR(board, 1) & bit)
+            return 2;
+        return 0;
+    }
 
 #endif
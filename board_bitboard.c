@@ -0,0 +1,224 @@
+/****************************************************
+ *  CHESS ENGINE by David Schoosleitner             *
+ * Date: 15.08.2022                                 *
+ * File: board_bitboard.c                           *
+ ****************************************************
+ * Responsibilities:                                *
+ *  - attack lookup tables                          *
+ *  - magic bitboards for sliding pieces            *
+ *  - zobrist keys                                  *
+ *                                                  *
+ * Requires:                                        *
+ *  - ...                                           *
+ ****************************************************/
+
+/***** INCLUDES *****/
+#include "board.h"
+
+/***** GLOBAL TABLES *****/
+ui64 Board_knight_table[64];                /* Knight attacks per square */
+ui64 Board_king_table[64];                  /* King attacks per square */
+ui64 Board_pawn_table[2][64];               /* Pawn capture attacks per color (0 = white, 1 = black) and square */
+BoardMagic_t Board_rook_magics[64];         /* Rook magic lookup per square */
+BoardMagic_t Board_bishop_magics[64];       /* Bishop magic lookup per square */
+ui64 Board_zobrist_piece[2][7][64];         /* Zobrist key per color, piece type and square */
+ui64 Board_zobrist_castle[16];              /* Zobrist key per castle flag combination, (META_CASTLE_A << 2) | META_CASTLE_H */
+ui64 Board_zobrist_passant[16];             /* Zobrist key per META_PASSANT_FILE, 8 = none */
+ui64 Board_zobrist_turn;                    /* Zobrist key toggled when black is in turn */
+
+/***** LOCAL CONSTANTS, STORAGE *****/
+static const signed char rook_steps[4][2] = {
+    {1,0}, {-1,0}, {0,1}, {0,-1}
+};
+
+static const signed char bishop_steps[4][2] = {
+    {1,1}, {1,-1}, {-1,1}, {-1,-1}
+};
+
+/* Collision free multipliers, found once with a sparse random search over the relevant occupancies */
+static const ui64 rook_magic_numbers[64] = {
+    0x0080004000802018ull, 0x0200120040208100ull, 0x0200088200221040ull, 0x4100042109001000ull,
+    0x0280080080040002ull, 0x4B00240018420D00ull, 0x040004100100A228ull, 0x0200008401004022ull,
+    0x0020800040002084ull, 0x3010808040002000ull, 0x8001001041002002ull, 0x4002801000800800ull,
+    0x4020800401080180ull, 0x6492000910020004ull, 0x0404000208500104ull, 0x8428800051002880ull,
+    0x0010208008400088ull, 0x0000808040002001ull, 0x0201820022134200ull, 0x1808008080100008ull,
+    0x0224028008008004ull, 0x4240080110200440ull, 0x0192004040010080ull, 0x0000A20004004081ull,
+    0x083C40008000842Cull, 0x3424200040085000ull, 0x8001001100200840ull, 0x2900100080080080ull,
+    0x5006080100100500ull, 0x0080400801042010ull, 0x0402000200080104ull, 0x0080034200192084ull,
+    0x1020004000808000ull, 0x4028401000402000ull, 0x2080200080801002ull, 0x0002002012000840ull,
+    0x0240802802800400ull, 0x5084800400800200ull, 0x0201800100800200ull, 0x0402004402002091ull,
+    0x4040082040848000ull, 0x0040201000404000ull, 0x0010002804002000ull, 0x8110010024110008ull,
+    0x0018000400088080ull, 0x0520040002008080ull, 0x8001000200010104ull, 0x0000010080420004ull,
+    0x8800228000400180ull, 0x0041085200802200ull, 0x40001040200D0100ull, 0x010023000A100100ull,
+    0x4148040081080180ull, 0x2202000408100200ull, 0xA040811002088400ull, 0x0004140080610200ull,
+    0x1000422012800103ull, 0x804103A201528142ull, 0x8A01000840102001ull, 0x0810000409002011ull,
+    0xA081000208001085ull, 0x2C02000490080102ull, 0x0000100130882A04ull, 0x0010108104004022ull,
+};
+
+static const ui64 bishop_magic_numbers[64] = {
+    0x4042200404144040ull, 0x0804044400420011ull, 0x0810208881000001ull, 0x601C04268A00A080ull,
+    0x8201104100030080ull, 0x4242088208080800ull, 0x0008881802910101ull, 0x820210480C046008ull,
+    0xC0D0045084080080ull, 0x0C10044828091420ull, 0x080C110104011008ull, 0x2041A40410830008ull,
+    0x58000E0A10054103ull, 0x5014020804040000ull, 0x0000820090094800ull, 0x8010202404028804ull,
+    0x4411004010021090ull, 0x082000080880A088ull, 0x0001041004008790ull, 0x1488004082004015ull,
+    0x0004000200940100ull, 0x00088208080C0200ull, 0x0001080048021000ull, 0x0032000108590405ull,
+    0xA010400028081900ull, 0x092402A010822800ull, 0x0045281024080064ull, 0x00C0040000410020ull,
+    0x805A001042005006ull, 0xC104420001411040ull, 0x4001284221041005ull, 0x2011020002260110ull,
+    0x4150442001100200ull, 0x1808084201080208ull, 0x0000280100080200ull, 0x4040080800060A00ull,
+    0x18822084004A0020ull, 0x0008010808010080ull, 0x0418011500040080ull, 0x10084102C8052201ull,
+    0x0002211040000810ull, 0x0000440220020800ull, 0x0025001882001000ull, 0x0014004200800801ull,
+    0x0420042502110403ull, 0x1914180088084500ull, 0x0842040114000200ull, 0x20A1154103001A04ull,
+    0x0064010109200010ull, 0x0062008218420080ull, 0x1024042C0208402Cull, 0x0024008020881140ull,
+    0x50000020208A4108ull, 0x0282405082068801ull, 0x40040404280A0000ull, 0x021608882B808040ull,
+    0x0142044208042210ull, 0x0020214108151000ull, 0x0A10200314411000ull, 0x0258004440208804ull,
+    0x4522294012020202ull, 0x8120044044040422ull, 0x0820050888080084ull, 0x4008022400420208ull,
+};
+
+static ui64 rook_attack_storage[102400];    /* Sum of 2^(relevant squares) over all squares */
+static ui64 bishop_attack_storage[5248];
+static int tables_state = 0;                /* 0 = not built || 1 = being built || 2 = ready */
+
+/***** LOCAL FUNCTIONALITY *****/
+
+/** @fn static ui64 Bitboard_step(signed short file, signed short rank)
+ * @brief Single square bitboard, or 0 if outside of the board
+ */
+static ui64 Bitboard_step(signed short file, signed short rank) {
+    if(file < 0 || file > 7 || rank < 0 || rank > 7)
+        return 0;
+    return CB_BIT(CB_SQUARE(file, rank));
+}
+
+/** @fn static ui64 Bitboard_ray_attacks(ui8 square, ui64 occupied, const signed char steps[4][2])
+ * @brief Slow slider attacks by walking each ray up to and including the first blocker, used to fill the tables
+ */
+static ui64 Bitboard_ray_attacks(ui8 square, ui64 occupied, const signed char steps[4][2]) {
+    ui64 attacks = 0;
+
+    for(ui8 d = 0; d < 4; d++) {
+        signed short f = CB_SQUARE_FILE(square) + steps[d][0];
+        signed short r = CB_SQUARE_RANK(square) + steps[d][1];
+
+        while(f >= 0 && f < 8 && r >= 0 && r < 8) {
+            attacks |= CB_BIT(CB_SQUARE(f, r));
+            if(occupied & CB_BIT(CB_SQUARE(f, r)))
+                break;
+            f += steps[d][0];
+            r += steps[d][1];
+        }
+    }
+
+    return attacks;
+}
+
+/** @fn static ui64 Bitboard_relevant_mask(ui8 square, const signed char steps[4][2])
+ * @brief Squares whose occupancy changes the attacks, the last square of every ray never blocks anything
+ */
+static ui64 Bitboard_relevant_mask(ui8 square, const signed char steps[4][2]) {
+    ui64 mask = 0;
+
+    for(ui8 d = 0; d < 4; d++) {
+        signed short f = CB_SQUARE_FILE(square) + steps[d][0];
+        signed short r = CB_SQUARE_RANK(square) + steps[d][1];
+
+        while(f + steps[d][0] >= 0 && f + steps[d][0] < 8 && r + steps[d][1] >= 0 && r + steps[d][1] < 8) {
+            mask |= CB_BIT(CB_SQUARE(f, r));
+            f += steps[d][0];
+            r += steps[d][1];
+        }
+    }
+
+    return mask;
+}
+
+/** @fn static void Bitboard_init_magics(BoardMagic_t *magics, ui64 *storage, const ui64 *numbers, const signed char steps[4][2])
+ * @brief Fills the attack table of every square for every subset of its relevant occupancy
+ */
+static void Bitboard_init_magics(BoardMagic_t *magics, ui64 *storage, const ui64 *numbers, const signed char steps[4][2]) {
+    for(ui8 sq = 0; sq < 64; sq++) {
+        BoardMagic_t *m = &magics[sq];
+        m->mask = Bitboard_relevant_mask(sq, steps);
+        m->magic = numbers[sq];
+        m->shift = 64 - CB_POPCOUNT(m->mask);
+        m->attacks = storage;
+
+        //Enumerate every subset of the mask (carry-rippler)
+        ui64 subset = 0;
+        do {
+            m->attacks[(subset * m->magic) >> m->shift] = Bitboard_ray_attacks(sq, subset, steps);
+            subset = (subset - m->mask) & m->mask;
+        } while(subset);
+
+        storage += CB_BIT(64 - m->shift);
+    }
+}
+
+/** @fn static ui64 Bitboard_next_random(ui64 *state)
+ * @brief Splitmix64, fixed seed so keys are the same in every run
+ */
+static ui64 Bitboard_next_random(ui64 *state) {
+    ui64 z = (*state += 0x9E3779B97F4A7C15ull);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+}
+
+/** @fn static void Bitboard_init_zobrist(void)
+ * @brief Fills the zobrist key tables
+ */
+static void Bitboard_init_zobrist(void) {
+    ui64 state = 0x43484544535A4F42ull;
+
+    for(ui8 c = 0; c < 2; c++) for(ui8 p = 0; p < 7; p++) for(ui8 sq = 0; sq < 64; sq++)
+        Board_zobrist_piece[c][p][sq] = (p == CB_EMPTY) ? 0 : Bitboard_next_random(&state);
+    for(ui8 i = 0; i < 16; i++)
+        Board_zobrist_castle[i] = Bitboard_next_random(&state);
+    for(ui8 i = 0; i < 16; i++)
+        Board_zobrist_passant[i] = Bitboard_next_random(&state);
+    Board_zobrist_turn = Bitboard_next_random(&state);
+}
+
+/***** FUNCTIONALITY *****/
+
+/** @fn void Board_init_tables(void)
+ * @brief Builds the attack lookup and zobrist tables once, called by Board_sync. Thread-safe, the first caller builds
+ * @brief and concurrent callers wait until the tables are complete
+ * @returns none
+ */
+void Board_init_tables(void) {
+    if(__atomic_load_n(&tables_state, __ATOMIC_ACQUIRE) == 2)
+        return;
+
+    //Only one thread builds, the others spin until it has published the tables
+    int expected = 0;
+    if(!__atomic_compare_exchange_n(&tables_state, &expected, 1, 0, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+        while(__atomic_load_n(&tables_state, __ATOMIC_ACQUIRE) != 2);
+        return;
+    }
+
+    //Leaper and pawn attacks
+    for(ui8 sq = 0; sq < 64; sq++) {
+        signed short f = CB_SQUARE_FILE(sq);
+        signed short r = CB_SQUARE_RANK(sq);
+
+        Board_knight_table[sq] =
+            Bitboard_step(f + 1, r + 2) | Bitboard_step(f + 1, r - 2) | Bitboard_step(f - 1, r + 2) | Bitboard_step(f - 1, r - 2) |
+            Bitboard_step(f + 2, r + 1) | Bitboard_step(f + 2, r - 1) | Bitboard_step(f - 2, r + 1) | Bitboard_step(f - 2, r - 1);
+
+        Board_king_table[sq] =
+            Bitboard_step(f + 1, r) | Bitboard_step(f + 1, r + 1) | Bitboard_step(f, r + 1) | Bitboard_step(f - 1, r + 1) |
+            Bitboard_step(f - 1, r) | Bitboard_step(f - 1, r - 1) | Bitboard_step(f, r - 1) | Bitboard_step(f + 1, r - 1);
+
+        Board_pawn_table[0][sq] = Bitboard_step(f - 1, r + 1) | Bitboard_step(f + 1, r + 1);
+        Board_pawn_table[1][sq] = Bitboard_step(f - 1, r - 1) | Bitboard_step(f + 1, r - 1);
+    }
+
+    //Slider attacks
+    Bitboard_init_magics(Board_rook_magics, rook_attack_storage, rook_magic_numbers, rook_steps);
+    Bitboard_init_magics(Board_bishop_magics, bishop_attack_storage, bishop_magic_numbers, bishop_steps);
+
+    //Position hashing
+    Bitboard_init_zobrist();
+
+    __atomic_store_n(&tables_state, 2, __ATOMIC_RELEASE);
+}
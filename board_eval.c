@@ -0,0 +1,339 @@
+/****************************************************
+ *  CHESS ENGINE by David Schoosleitner             *
+ * Date: 15.08.2022                                 *
+ * File: board_eval.c                               *
+ ****************************************************
+ * Responsibilities:                                *
+ *  - static position evaluation                    *
+ *  - piece-square tables, kept up to date by board *
+ *  - pawn structure, cached in a pawn table        *
+ *  - static exchange evaluation                    *
+ *                                                  *
+ * Requires:                                        *
+ *  - board_bitboard.c                              *
+ ****************************************************/
+
+/***** INCLUDES *****/
+#include "board.h"
+#include <stdlib.h>
+
+/***** LOCAL CONSTANTS *****/
+#define EVAL_SEE_KING (20000)       /* Exchange value of the king, it may only capture last */
+#define EVAL_PHASE_MAX (24)         /* Phase of the starting material, the middlegame end of the taper */
+
+#define EVAL_DOUBLED_MG (-10)       /* Per extra pawn on a file */
+#define EVAL_DOUBLED_EG (-20)
+#define EVAL_ISOLATED_MG (-10)      /* Per pawn without own pawns on the neighbour files */
+#define EVAL_ISOLATED_EG (-15)
+#define EVAL_SHIELD_ADVANCED (-10)  /* Shield pawn one rank further up */
+#define EVAL_SHIELD_MISSING (-25)   /* No shield pawn on the first two ranks in front of the king */
+#define EVAL_PAWN_UNUSED (1)        /* Key of unused pawn table entries, a real pawn key is practically never 1 */
+
+/***** LOCAL TABLES *****/
+/* Piece-square tables from white's view, a8 first so they read like a board. Black looks them up mirrored */
+static const short Eval_none[64] = {0};
+
+static const short Eval_pawn_mg[64] = {
+      0,   0,   0,   0,   0,   0,   0,   0,
+     50,  50,  50,  50,  50,  50,  50,  50,
+     10,  10,  20,  30,  30,  20,  10,  10,
+      5,   5,  10,  25,  25,  10,   5,   5,
+      0,   0,   0,  20,  20,   0,   0,   0,
+      5,  -5, -10,   0,   0, -10,  -5,   5,
+      5,  10,  10, -20, -20,  10,  10,   5,
+      0,   0,   0,   0,   0,   0,   0,   0
+};
+
+static const short Eval_pawn_eg[64] = {
+      0,   0,   0,   0,   0,   0,   0,   0,
+     80,  80,  80,  80,  80,  80,  80,  80,
+     50,  50,  50,  50,  50,  50,  50,  50,
+     30,  30,  30,  30,  30,  30,  30,  30,
+     20,  20,  20,  20,  20,  20,  20,  20,
+     10,  10,  10,  10,  10,  10,  10,  10,
+      0,   0,   0,   0,   0,   0,   0,   0,
+      0,   0,   0,   0,   0,   0,   0,   0
+};
+
+static const short Eval_knight[64] = {
+    -50, -40, -30, -30, -30, -30, -40, -50,
+    -40, -20,   0,   0,   0,   0, -20, -40,
+    -30,   0,  10,  15,  15,  10,   0, -30,
+    -30,   5,  15,  20,  20,  15,   5, -30,
+    -30,   0,  15,  20,  20,  15,   0, -30,
+    -30,   5,  10,  15,  15,  10,   5, -30,
+    -40, -20,   0,   5,   5,   0, -20, -40,
+    -50, -40, -30, -30, -30, -30, -40, -50
+};
+
+static const short Eval_bishop[64] = {
+    -20, -10, -10, -10, -10, -10, -10, -20,
+    -10,   0,   0,   0,   0,   0,   0, -10,
+    -10,   0,   5,  10,  10,   5,   0, -10,
+    -10,   5,   5,  10,  10,   5,   5, -10,
+    -10,   0,  10,  10,  10,  10,   0, -10,
+    -10,  10,  10,  10,  10,  10,  10, -10,
+    -10,   5,   0,   0,   0,   0,   5, -10,
+    -20, -10, -10, -10, -10, -10, -10, -20
+};
+
+static const short Eval_rook[64] = {
+      0,   0,   0,   0,   0,   0,   0,   0,
+      5,  10,  10,  10,  10,  10,  10,   5,
+     -5,   0,   0,   0,   0,   0,   0,  -5,
+     -5,   0,   0,   0,   0,   0,   0,  -5,
+     -5,   0,   0,   0,   0,   0,   0,  -5,
+     -5,   0,   0,   0,   0,   0,   0,  -5,
+     -5,   0,   0,   0,   0,   0,   0,  -5,
+      0,   0,   0,   5,   5,   0,   0,   0
+};
+
+static const short Eval_queen[64] = {
+    -20, -10, -10,  -5,  -5, -10, -10, -20,
+    -10,   0,   0,   0,   0,   0,   0, -10,
+    -10,   0,   5,   5,   5,   5,   0, -10,
+     -5,   0,   5,   5,   5,   5,   0,  -5,
+      0,   0,   5,   5,   5,   5,   0,  -5,
+    -10,   5,   5,   5,   5,   5,   0, -10,
+    -10,   0,   5,   0,   0,   0,   0, -10,
+    -20, -10, -10,  -5,  -5, -10, -10, -20
+};
+
+static const short Eval_king_mg[64] = {
+    -30, -40, -40, -50, -50, -40, -40, -30,
+    -30, -40, -40, -50, -50, -40, -40, -30,
+    -30, -40, -40, -50, -50, -40, -40, -30,
+    -30, -40, -40, -50, -50, -40, -40, -30,
+    -20, -30, -30, -40, -40, -30, -30, -20,
+    -10, -20, -20, -20, -20, -20, -20, -10,
+     20,  20,   0,   0,   0,   0,  20,  20,
+     20,  30,  10,   0,   0,  10,  30,  20
+};
+
+static const short Eval_king_eg[64] = {
+    -50, -40, -30, -20, -20, -30, -40, -50,
+    -30, -20, -10,   0,   0, -10, -20, -30,
+    -30, -10,  20,  30,  30,  20, -10, -30,
+    -30, -10,  30,  40,  40,  30, -10, -30,
+    -30, -10,  30,  40,  40,  30, -10, -30,
+    -30, -10,  20,  30,  30,  20, -10, -30,
+    -30, -30,   0,   0,   0,   0, -30, -30,
+    -50, -30, -30, -30, -30, -30, -30, -50
+};
+
+/* Passed pawn bonus by rank as seen from its own side */
+static const short Eval_passed_mg[8] = {0, 5, 10, 15, 25, 40, 60, 0};
+static const short Eval_passed_eg[8] = {0, 10, 15, 25, 40, 65, 100, 0};
+
+/***** GLOBAL TABLES *****/
+const int Board_piece_values[7] = {
+    0, 100, 500, 320, 330, 900, 0      /* Indexed by piece type, the king is never traded */
+};
+
+const short *const Board_psqt[2][7] = {
+    {Eval_none, Eval_pawn_mg, Eval_rook, Eval_knight, Eval_bishop, Eval_queen, Eval_king_mg},   /* Middlegame */
+    {Eval_none, Eval_pawn_eg, Eval_rook, Eval_knight, Eval_bishop, Eval_queen, Eval_king_eg}    /* Endgame */
+};
+
+const ui8 Board_phase_weights[7] = {
+    0, 0, 2, 1, 1, 4, 0                 /* Indexed by piece type, pawns and kings don't count */
+};
+
+/***** LOCAL FUNCTIONALITY *****/
+
+/** @fn static void Eval_pawns(const Board_t *board, BoardPawnEntry_t *entry)
+ * @brief Evaluates the pawn structure from scratch: doubled, isolated and passed pawns, and the shield in front of
+ * @brief a king castled to either wing. Only depends on the pawns, so the result is valid for every position with the same pawn key
+ * @param entry Filled in, including the key
+ */
+static void Eval_pawns(const Board_t *board, BoardPawnEntry_t *entry) {
+    int mg = 0, eg = 0;
+
+    for(ui8 c = 0; c < 2; c++) {
+        int sign = c ? -1 : 1;
+        ui64 own = CB_BB_PIECE(board, c, CB_PAWN);
+        ui64 enemy = CB_BB_PIECE(board, 1 - c, CB_PAWN);
+
+        //Step 1: Files, doubled and isolated pawns
+        for(ui8 f = 0; f < 8; f++) {
+            ui8 count = CB_POPCOUNT(own & CB_FILE_BB(f));
+            if(!count)
+                continue;
+
+            ui64 neighbours = ((f > 0) ? CB_FILE_BB(f - 1) : 0) | ((f < 7) ? CB_FILE_BB(f + 1) : 0);
+            mg += sign * ((count - 1) * EVAL_DOUBLED_MG + (!(own & neighbours) ? count * EVAL_ISOLATED_MG : 0));
+            eg += sign * ((count - 1) * EVAL_DOUBLED_EG + (!(own & neighbours) ? count * EVAL_ISOLATED_EG : 0));
+        }
+
+        //Step 2: Passed pawns, no enemy pawn ahead on the own or a neighbour file
+        for(ui64 pawns = own; pawns; pawns &= pawns - 1) {
+            ui8 square = __builtin_ctzll(pawns);
+            ui8 f = CB_SQUARE_FILE(square);
+            ui8 r = CB_SQUARE_RANK(square);
+            ui64 span = CB_FILE_BB(f) | ((f > 0) ? CB_FILE_BB(f - 1) : 0) | ((f < 7) ? CB_FILE_BB(f + 1) : 0);
+            ui64 front = c ? ((((ui64) 1) << (r * 8)) - 1) : ((r < 7) ? (~((ui64) 0) << ((r + 1) * 8)) : 0);
+
+            if(!(enemy & span & front)) {
+                ui8 relative = c ? 7 - r : r;
+                mg += sign * Eval_passed_mg[relative];
+                eg += sign * Eval_passed_eg[relative];
+            }
+        }
+
+        //Step 3: Shields of both wings, used once the king stands behind one
+        ui8 up = c ? 6 : 1;
+        ui8 further = c ? 5 : 2;
+        for(ui8 wing = 0; wing < 2; wing++) {
+            short shield = 0;
+            for(ui8 f = wing ? CB_FILE_F : CB_FILE_A; f <= (wing ? CB_FILE_H : CB_FILE_C); f++) {
+                if(own & CB_BIT(CB_SQUARE(f, up)))
+                    continue;
+                shield += (own & CB_BIT(CB_SQUARE(f, further))) ? EVAL_SHIELD_ADVANCED : EVAL_SHIELD_MISSING;
+            }
+            entry->shield[c][wing] = shield;
+        }
+    }
+
+    entry->key = board->pawn_key;
+    entry->mg = mg;
+    entry->eg = eg;
+}
+
+/***** FUNCTIONALITY *****/
+
+/** @fn int Board_evaluate(const Board_t *board, BoardPawnTable_t *pawns)
+ * @brief Static evaluation in centipawns from the view of the side in turn: material and piece-square tables, tapered
+ * @brief from middlegame to endgame weights as pieces come off. Reads the totals the board keeps, nothing is counted here.
+ * @brief Boards with an attached accumulator are evaluated by the network instead
+ * @param board Board to be evaluated
+ * @param pawns Pawn table of the calling thread || NULL - pawn structure evaluated every time
+ * @returns Score, positive if the side in turn is better
+ */
+int Board_evaluate(const Board_t *board, BoardPawnTable_t *pawns) {
+    if(board->nnue)
+        return Board_nnue_evaluate(board);
+
+    int phase = (board->phase > EVAL_PHASE_MAX) ? EVAL_PHASE_MAX : board->phase;
+    int mg = board->psqt_mg;
+    int eg = board->psqt_eg;
+
+    //Step 1: Pawn structure, from the table if the structure was seen before
+    BoardPawnEntry_t local;
+    BoardPawnEntry_t *entry = &local;
+    if(pawns && pawns->entries) {
+        entry = &pawns->entries[board->pawn_key & (pawns->size - 1)];
+        if(entry->key == board->pawn_key)
+            pawns->hits++;
+        else {
+            pawns->misses++;
+            Eval_pawns(board, entry);
+        }
+    }
+    else
+        Eval_pawns(board, entry);
+    mg += entry->mg;
+    eg += entry->eg;
+
+    //Step 2: Shield of a king on its back ranks behind a wing, a middlegame term
+    for(ui8 c = 0; c < 2; c++) {
+        ui8 king = board->king_square[c];
+        if(king == CB_NO_SQUARE || CB_SQUARE_RANK(king) != (c ? 7 : 0))
+            continue;
+        if(CB_SQUARE_FILE(king) <= CB_FILE_C)
+            mg += c ? -entry->shield[c][0] : entry->shield[c][0];
+        else if(CB_SQUARE_FILE(king) >= CB_FILE_F)
+            mg += c ? -entry->shield[c][1] : entry->shield[c][1];
+    }
+
+    int score = (mg * phase + eg * (EVAL_PHASE_MAX - phase)) / EVAL_PHASE_MAX;
+
+    return (board->turn == CB_TURN_WHITE) ? score : -score;
+}
+
+/** @fn int Board_see(const Board_t *board, BoardMove_t move)
+ * @brief Static exchange evaluation, plays out every capture on the target square with the least valuable attacker
+ * @brief first. Attackers_to is asked again after each capture so x-ray attackers behind it join in. Either side may
+ * @brief stop capturing when it would lose material. Pins are not considered
+ * @param board Board before the move
+ * @param move Move with its code, usually a capture
+ * @returns Material balance in centipawns for the side making the move
+ */
+int Board_see(const Board_t *board, BoardMove_t move) {
+    int gain[32];
+    ui8 depth = 0;
+    ui8 target = Board_move_target(board, move);
+    ui8 from = CB_SQUARE(move.from_file, move.from_rank);
+    ui8 piece = CB_PIECE_TYPE(board->content[move.from_file][move.from_rank]);
+    ui64 occupied = CB_BB_OCCUPIED(board) & ~CB_BIT(from);
+
+    //Castling never captures
+    if(move.code == 6 || move.code == 7)
+        return 0;
+
+    //Step 1: The move itself, en passant removes a pawn beside the target and promotions change the piece on it
+    gain[0] = Board_piece_values[Board_move_victim(board, move)];
+    if(move.code == 5)
+        occupied &= ~CB_BIT(CB_SQUARE(move.to_file, move.from_rank));
+    if(CB_IS_PROMOTION(move.code)) {
+        ui8 promoted = CB_PROMOTION_PIECE(move.code);
+        gain[0] += Board_piece_values[promoted] - Board_piece_values[CB_PAWN];
+        piece = promoted;
+    }
+
+    //Step 2: Alternate recaptures with the least valuable attacker, each gain assumes the piece on the square is lost next
+    ui8 side = 1 - (Board_color_field_p(board, move.from_file, move.from_rank) - 1);
+    int on_square = (piece == CB_KING) ? EVAL_SEE_KING : Board_piece_values[piece];
+    while(depth < 31) {
+        ui64 attackers = Board_attackers_to(board, target, occupied) & occupied & CB_BB_COLOR(board, side);
+        if(!attackers)
+            break;
+
+        ui8 type = CB_PAWN;
+        while(type <= CB_KING && !(attackers & CB_BB_PIECE(board, side, type)))
+            type++;
+
+        depth++;
+        gain[depth] = on_square - gain[depth - 1];
+        on_square = (type == CB_KING) ? EVAL_SEE_KING : Board_piece_values[type];
+        occupied &= ~CB_BIT(__builtin_ctzll(attackers & CB_BB_PIECE(board, side, type)));
+        side = 1 - side;
+    }
+
+    //Step 3: Back to front, a side stops capturing where continuing would be worse
+    for(; depth; depth--)
+        if(gain[depth] > -gain[depth - 1])
+            gain[depth - 1] = -gain[depth];
+
+    return gain[0];
+}
+
+/** @fn ui8 Board_pawn_table_init(BoardPawnTable_t *pawns, __SIZE_TYPE__ kilobytes)
+ * @brief Allocates an empty pawn table, the entry count is the largest power of two within the budget
+ * @param pawns Table to be initialized
+ * @param kilobytes Memory budget, at least 1
+ * @returns is successful: 1 | else: 0
+ */
+ui8 Board_pawn_table_init(BoardPawnTable_t *pawns, __SIZE_TYPE__ kilobytes) {
+    __SIZE_TYPE__ size = 1;
+    while(size * 2 * sizeof(BoardPawnEntry_t) <= kilobytes * 1024)
+        size *= 2;
+
+    pawns->entries = (BoardPawnEntry_t*) malloc(size * sizeof(BoardPawnEntry_t));
+    pawns->size = pawns->entries ? size : 0;
+    pawns->hits = 0;
+    pawns->misses = 0;
+    for(__SIZE_TYPE__ i = 0; i < pawns->size; i++)
+        pawns->entries[i].key = EVAL_PAWN_UNUSED;
+    return pawns->entries != NULL;
+}
+
+/** @fn void Board_pawn_table_free(BoardPawnTable_t *pawns)
+ * @brief Releases a pawn table
+ * @param pawns Table to be freed
+ * @returns none
+ */
+void Board_pawn_table_free(BoardPawnTable_t *pawns) {
+    free(pawns->entries);
+    pawns->entries = NULL;
+    pawns->size = 0;
+}
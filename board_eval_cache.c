@@ -0,0 +1,101 @@
+/****************************************************
+ *  CHESS ENGINE by David Schoosleitner             *
+ * Date: 15.08.2022                                 *
+ * File: board_eval_cache.c                         *
+ ****************************************************
+ * Responsibilities:                                *
+ *  - evaluation cache shared by search threads     *
+ *                                                  *
+ * Requires:                                        *
+ *  - ...                                           *
+ ****************************************************/
+
+/***** INCLUDES *****/
+#include "board.h"
+#include <stdlib.h>
+#include <string.h>
+
+/*
+ * ENTRY FORMATTING:
+ * bits  0-15 - score, two's complement
+ * bits 16-63 - the same bits of the key
+ *
+ * The low key bits pick the entry, the high ones are kept for verification. One word per
+ * entry is written and read atomically, so entries can't tear between threads.
+ */
+
+/***** LOCAL CONSTANTS *****/
+#define EVAL_CACHE_SCORE_MASK ((ui64) 0xFFFF)
+
+/***** FUNCTIONALITY *****/
+
+/** @fn ui8 Board_eval_cache_init(BoardEvalCache_t *cache, __SIZE_TYPE__ megabytes)
+ * @brief Allocates an empty evaluation cache, the entry count is the largest power of two within the budget
+ * @param cache Cache to be initialized
+ * @param megabytes Memory budget, at least 1
+ * @returns is successful: 1 | else: 0
+ */
+ui8 Board_eval_cache_init(BoardEvalCache_t *cache, __SIZE_TYPE__ megabytes) {
+    __SIZE_TYPE__ size = 1;
+    while(size * 2 * sizeof(ui64) <= megabytes * 1024 * 1024)
+        size *= 2;
+
+    cache->entries = (ui64*) malloc(size * sizeof(ui64));
+    cache->size = cache->entries ? size : 0;
+    cache->hits = 0;
+    cache->misses = 0;
+    if(cache->entries)
+        Board_eval_cache_clear(cache);
+    return cache->entries != NULL;
+}
+
+/** @fn void Board_eval_cache_free(BoardEvalCache_t *cache)
+ * @brief Releases an evaluation cache
+ * @param cache Cache to be freed
+ * @returns none
+ */
+void Board_eval_cache_free(BoardEvalCache_t *cache) {
+    free(cache->entries);
+    cache->entries = NULL;
+    cache->size = 0;
+}
+
+/** @fn void Board_eval_cache_clear(BoardEvalCache_t *cache)
+ * @brief Forgets every entry, required once the evaluation itself changes, e.g. after loading a network
+ * @param cache Cache to be cleared
+ * @returns none
+ */
+void Board_eval_cache_clear(BoardEvalCache_t *cache) {
+    memset(cache->entries, 0, cache->size * sizeof(ui64));
+}
+
+/** @fn ui8 Board_eval_cache_probe(const BoardEvalCache_t *cache, ui64 key, int *score)
+ * @brief Looks up the static evaluation of a position
+ * @param cache Cache
+ * @param key Board_t.key of the position
+ * @param score Filled on a hit
+ * @returns 1 - hit || 0 - miss
+ */
+ui8 Board_eval_cache_probe(const BoardEvalCache_t *cache, ui64 key, int *score) {
+    ui64 entry = __atomic_load_n(&cache->entries[key & (cache->size - 1)], __ATOMIC_RELAXED);
+
+    if((entry ^ key) & ~EVAL_CACHE_SCORE_MASK)
+        return 0;
+    *score = (short) (entry & EVAL_CACHE_SCORE_MASK);
+    return 1;
+}
+
+/** @fn void Board_eval_cache_store(BoardEvalCache_t *cache, ui64 key, int score)
+ * @brief Stores the static evaluation of a position, always replacing
+ * @param cache Cache
+ * @param key Board_t.key of the position
+ * @param score Board_evaluate result, clipped to 16 bits
+ * @returns none
+ */
+void Board_eval_cache_store(BoardEvalCache_t *cache, ui64 key, int score) {
+    if(score > 32767) score = 32767;
+    if(score < -32767) score = -32767;
+
+    ui64 entry = (key & ~EVAL_CACHE_SCORE_MASK) | ((ui64) (__UINT16_TYPE__) score);
+    __atomic_store_n(&cache->entries[key & (cache->size - 1)], entry, __ATOMIC_RELAXED);
+}
@@ -5,6 +5,7 @@
  ****************************************************
  * Responsibilities:                                *
  *  - loading board from primitive                  *
+ *  - loading board from FEN                        *
  *                                                  *
  * Requires:                                        *
  *  - ...                                           *
@@ -70,13 +71,111 @@ ui8 Board_load_from_file(Board_t *board, char *path) {
     return Board_load_from_string(board, buffer);
 }
 
-/** @fn ui8 Board_save_to_file(Board_t board, char *path)
+/** @fn ui8 Board_load_from_fen(Board_t *board, const char *fen)
+ * @brief Load a board from Forsyth-Edwards Notation, halfmove clock is ignored
+ * @param board Pointer to board to be initialized
+ * @param fen FEN string, e.g. "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1"
+ * @returns is successful: 1 | else: 0
+ */
+ui8 Board_load_from_fen(Board_t *board, const char *fen) {
+    //Intermediate storage in case of mishaps
+    Board_t loaded;
+    loaded.nnue = NULL;
+
+    for(ui8 f = 0; f < 8; f++) for(ui8 r = 0; r < 8; r++)
+        loaded.content[f][r] = CB_EMPTY;
+
+    //Step 1: Placement, rank 8 first
+    signed short file = 0;
+    signed short rank = 7;
+    for(; *fen && *fen != ' '; fen++) {
+        char c = *fen;
+        if(c == '/') {
+            if(file != 8 || rank == 0) return 0;
+            file = 0;
+            rank--;
+            continue;
+        }
+        if(c >= '1' && c <= '8') {
+            file += c - '0';
+            if(file > 8) return 0;
+            continue;
+        }
+
+        ui8 mask = (c >= 'a') ? CB_BLACK_MASK : CB_WHITE_MASK;
+        if(c >= 'a') c -= 'a'-'A';
+        ui8 piece;
+        switch(c) {
+            case 'P': piece = CB_PAWN; break;
+            case 'R': piece = CB_ROOK; break;
+            case 'N': piece = CB_KNIGHT; break;
+            case 'B': piece = CB_BISHOP; break;
+            case 'Q': piece = CB_QUEEN; break;
+            case 'K': piece = CB_KING; break;
+            default: return 0;
+        }
+        if(file > 7) return 0;
+        loaded.content[file++][rank] = piece | mask;
+    }
+    if(file != 8 || rank != 0 || *fen++ != ' ')
+        return 0;
+
+    //Step 2: Turn
+    if(*fen != 'w' && *fen != 'b')
+        return 0;
+    loaded.turn = (*fen++ == 'w') ? CB_TURN_WHITE : CB_TURN_BLACK;
+    if(*fen++ != ' ')
+        return 0;
+
+    //Step 3: Castling, bit 2 for white, bit 1 for black
+    loaded.META_CASTLE_A = 0;
+    loaded.META_CASTLE_H = 0;
+    for(; *fen && *fen != ' '; fen++) {
+        switch(*fen) {
+            case 'K': loaded.META_CASTLE_H |= 2; break;
+            case 'Q': loaded.META_CASTLE_A |= 2; break;
+            case 'k': loaded.META_CASTLE_H |= 1; break;
+            case 'q': loaded.META_CASTLE_A |= 1; break;
+            case '-': break;
+            default: return 0;
+        }
+    }
+    if(*fen++ != ' ')
+        return 0;
+
+    //Step 4: En passant, only the file is stored
+    loaded.META_PASSANT_FILE = 8;
+    if(*fen >= 'a' && *fen <= 'h') {
+        loaded.META_PASSANT_FILE = *fen++ - 'a';
+        if(*fen < '1' || *fen > '8') return 0;
+        fen++;
+    }
+    else if(*fen++ != '-')
+        return 0;
+
+    //Step 5: Move counters, optional
+    unsigned int halfmove = 0;
+    unsigned int fullmove = 1;
+    sscanf(fen, " %u %u", &halfmove, &fullmove);
+    if(fullmove < 1) fullmove = 1;
+    loaded.turn_nr = (fullmove - 1) * 2 + loaded.turn;
+
+    loaded.CB_ALLOW_DEFAULT_SPM = 1;
+    loaded.win = 0;
+
+    // Successful load, mirror into bitboards and clone
+    Board_sync(&loaded);
+    Board_clone_p(board, &loaded);
+    return 1;
+}
+
+/** @fn ui8 Board_save_to_file_p(const Board_t *board, char *path)
  * @brief Save board content into path
  * @param board Board to be saved
  * @param path Path to file
  * @returns is successful: 1 | else: 0
  */
-ui8 Board_save_to_file(Board_t board, char *path)
+ui8 Board_save_to_file_p(const Board_t *board, char *path)
 {
     FILE* file = fopen(path, "wb");
     int res;
@@ -124,18 +223,18 @@ ui8 Board_save_to_file(Board_t board, char *path)
     const char *begin = CB_CURRENT_FILE_HEADER;
 
     const unsigned char attr[4] = {
-        ((board.CB_ALLOW_DEFAULT_SPM & 0x01u) << 7) |
-        ((board.META_CASTLE_A & 0x03u) << 5)        |
-        ((board.META_CASTLE_H & 0x03u) << 3)        |
-        ((board.META_PASSANT_FILE & 0x0Eu) >> 1)    ,
+        ((board->CB_ALLOW_DEFAULT_SPM & 0x01u) << 7) |
+        ((board->META_CASTLE_A & 0x03u) << 5)        |
+        ((board->META_CASTLE_H & 0x03u) << 3)        |
+        ((board->META_PASSANT_FILE & 0x0Eu) >> 1)    ,
 
-        ((board.META_PASSANT_FILE & 0x01u) << 7)    |
-        ((board.turn & 0x01u) << 6)                 |
-        ((board.win & 0x03u) << 4)                  ,
+        ((board->META_PASSANT_FILE & 0x01u) << 7)    |
+        ((board->turn & 0x01u) << 6)                 |
+        ((board->win & 0x03u) << 4)                  ,
 
-        (ui8) (board.turn_nr >> 8)                  ,
+        (ui8) (board->turn_nr >> 8)                  ,
 
-        (ui8) (board.turn_nr)                       ,
+        (ui8) (board->turn_nr)                       ,
     };
 
     const unsigned char white_cmd = 0x40;
@@ -165,8 +264,8 @@ ui8 Board_save_to_file(Board_t board, char *path)
 
     // Save all pieces into the string buffers
     for(f = 0; f < 8; f++) for(r = 0; r < 8; r++) {
-        piece = (board.content[f][r]) & ~(CB_WHITE_MASK | CB_BLACK_MASK);
-        color = Board_color_field(board, f, r);
+        piece = (board->content[f][r]) & ~(CB_WHITE_MASK | CB_BLACK_MASK);
+        color = Board_color_field_p(board, f, r);
 
         out =
             ((color == 1) ? (white_cmd) : (black_cmd))  |
@@ -244,6 +343,13 @@ ui8 Board_save_to_file(Board_t board, char *path)
     return (fclose(file) == 0);
 }
 
+/** @fn ui8 Board_save_to_file(Board_t board, char *path)
+ * @brief By value variant of Board_save_to_file_p
+ */
+ui8 Board_save_to_file(Board_t board, char *path) {
+    return Board_save_to_file_p(&board, path);
+}
+
 /** @fn ui8 Tool_Match(char *literal, const char *match, long at)
  * @brief Matches a literal with another literal. An offset is available
  * @param literal String to be checked
@@ -281,6 +387,7 @@ ui8 VER1_0_1(Board_t *orig_brd, char *str)
 {
     //Intermediate storage in case of mishaps
     Board_t board;
+    board.nnue = NULL;
 
     //Set board content to empty
     for(ui8 f = 0; f < 8; f++) for(ui8 r = 0; r < 8; r++) {
@@ -401,7 +508,8 @@ ui8 VER1_0_1(Board_t *orig_brd, char *str)
     if(!valid_load)
         return 0;
     
-    // Successful load and clone
-    Board_clone(orig_brd, board);
+    // Successful load, mirror into bitboards and clone
+    Board_sync(&board);
+    Board_clone_p(orig_brd, &board);
     return 1;
 }
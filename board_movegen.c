@@ -0,0 +1,301 @@
+/****************************************************
+ *  CHESS ENGINE by David Schoosleitner             *
+ * Date: 15.08.2022                                 *
+ * File: board_movegen.c                            *
+ ****************************************************
+ * Responsibilities:                                *
+ *  - legal move generation                         *
+ *  - capture and quiet stages for the search       *
+ *                                                  *
+ * Requires:                                        *
+ *  - board.c                                       *
+ ****************************************************/
+
+/***** INCLUDES *****/
+#include "board.h"
+
+/***** LOCAL CONSTANTS *****/
+#define MOVEGEN_NOISY (1)           /* Captures, en passant and promotions */
+#define MOVEGEN_QUIET (2)           /* Everything else, castling included */
+#define MOVEGEN_ALL (MOVEGEN_NOISY | MOVEGEN_QUIET)
+
+/***** LOCAL TYPES *****/
+typedef struct Movegen_t_s {
+    Board_t *board;                 /* Scratch copy of the position, restored after every candidate */
+    BoardUndoStack_t stack;         /* Undo stack for the scratch copy */
+    BoardMoveList_t *list;          /* Output */
+    ui8 color;                      /* Color in turn, 1 = white, 2 = black */
+    ui8 kind;                       /* MOVEGEN_NOISY, MOVEGEN_QUIET or both */
+} Movegen_t;
+
+/***** LOCAL FUNCTIONALITY *****/
+
+/** @fn static void Movegen_push(Movegen_t *gen, BoardMove_t move)
+ * @brief Validates a candidate move with the rules core and appends it if it doesn't leave the own king in check
+ * @param gen Generator state
+ * @param move Candidate move, a preset code skips the rules core
+ * @returns none
+ */
+static void Movegen_push(Movegen_t *gen, BoardMove_t move) {
+    ui8 code = move.code ? move.code : Board_legal_move_p(gen->board, move);
+    if(!code)
+        return;
+
+    //King safety, played and taken back on the scratch board
+    move.code = code;
+    Board_make_move(gen->board, move, &gen->stack);
+    ui8 check = Board_in_check_p(gen->board, gen->color);
+    Board_unmake_move(gen->board, &gen->stack);
+    if(check)
+        return;
+
+    if(gen->list->count >= CB_MAX_MOVES)
+        return;
+    gen->list->moves[gen->list->count++] = move;
+}
+
+/** @fn static void Movegen_candidate(Movegen_t *gen, ui8 ff, ui8 fr, signed short tf, signed short tr, ui8 special)
+ * @brief Builds a candidate move, discarding targets outside of the board
+ * @returns none
+ */
+static void Movegen_candidate(Movegen_t *gen, ui8 ff, ui8 fr, signed short tf, signed short tr, ui8 special) {
+    if(tf < 0 || tf > 7 || tr < 0 || tr > 7)
+        return;
+
+    BoardMove_t move = {
+        .from_file = ff,
+        .from_rank = fr,
+        .to_file = tf,
+        .to_rank = tr,
+        .special = special,
+        .code = 0
+    };
+    Movegen_push(gen, move);
+}
+
+/** @fn static void Movegen_pawn(Movegen_t *gen, ui8 f, ui8 r)
+ * @brief Candidate pawn pushes, captures and promotions
+ * @returns none
+ */
+static void Movegen_pawn(Movegen_t *gen, ui8 f, ui8 r) {
+    signed short direction = (gen->color == 1) ? 1 : -1;
+    signed short next = r + direction;
+
+    //Promotions are encoded with the piece in to_file and the opposite back rank in to_rank
+    if(next == 0 || next == 7) {
+        if(!(gen->kind & MOVEGEN_NOISY))
+            return;
+
+        ui8 marker = (next == 7) ? 0 : 7;
+        for(ui8 p = 0; p < 4; p++) {
+            Movegen_candidate(gen, f, r, p, marker, 0);
+            Movegen_candidate(gen, f, r, p, marker, 1);
+            Movegen_candidate(gen, f, r, p, marker, 2);
+        }
+        return;
+    }
+
+    //Pushes
+    if(gen->kind & MOVEGEN_QUIET) {
+        Movegen_candidate(gen, f, r, f, next, 0);
+        if(r == 1 || r == 6)
+            Movegen_candidate(gen, f, r, f, next + direction, 0);
+    }
+
+    //Captures, including en passant
+    if(gen->kind & MOVEGEN_NOISY) {
+        Movegen_candidate(gen, f, r, f - 1, next, 0);
+        Movegen_candidate(gen, f, r, f + 1, next, 0);
+    }
+}
+
+/** @fn static void Movegen_targets(Movegen_t *gen, ui8 from, ui64 targets, ui8 validate)
+ * @brief Candidate moves from one square to every square of a target set
+ * @param validate 0 - targets are attack table moves, only capture or not matters || 1 - ask the rules core
+ * @returns none
+ */
+static void Movegen_targets(Movegen_t *gen, ui8 from, ui64 targets, ui8 validate) {
+    ui64 opponent = CB_BB_COLOR(gen->board, 2 - gen->color);
+
+    if(!(gen->kind & MOVEGEN_NOISY))
+        targets &= ~opponent;
+    if(!(gen->kind & MOVEGEN_QUIET))
+        targets &= opponent;
+
+    while(targets) {
+        ui8 to = __builtin_ctzll(targets);
+        targets &= targets - 1;
+
+        BoardMove_t move = {
+            .from_file = CB_SQUARE_FILE(from),
+            .from_rank = CB_SQUARE_RANK(from),
+            .to_file = CB_SQUARE_FILE(to),
+            .to_rank = CB_SQUARE_RANK(to),
+            .special = 0,
+            .code = validate ? 0 : ((opponent & CB_BIT(to)) ? 2 : 1)
+        };
+        Movegen_push(gen, move);
+    }
+}
+
+/** @fn static __UINT16_TYPE__ Movegen_run(const Board_t *board, ui8 color, BoardMoveList_t *list, __UINT16_TYPE__ limit, ui8 type, ui8 kind)
+ * @brief Generates legal moves along the piece list, stopping once limit moves are found
+ * @param color Side to generate for, 1 = white, 2 = black
+ * @param type Only pieces of this type, CB_EMPTY for all
+ * @param kind MOVEGEN_NOISY, MOVEGEN_QUIET or MOVEGEN_ALL
+ * @returns Number of legal moves found
+ */
+static __UINT16_TYPE__ Movegen_run(const Board_t *board, ui8 color, BoardMoveList_t *list, __UINT16_TYPE__ limit, ui8 type, ui8 kind) {
+    Board_t scratch;
+    BoardUndo_t records[1];
+    Movegen_t generator = {
+        .board = &scratch,
+        .stack = CB_UNDO_STACK(records),
+        .list = list,
+        .color = color,
+        .kind = kind
+    };
+    Movegen_t *gen = &generator;
+    ui8 side = gen->color - 1;
+    ui64 occupied = CB_BB_OCCUPIED(board);
+
+    Board_clone_p(&scratch, board);
+    scratch.turn = (color == 1) ? CB_TURN_WHITE : CB_TURN_BLACK;
+    list->count = 0;
+
+    for(ui8 i = 0; i < board->piece_count[side] && list->count < limit; i++) {
+        ui8 square = board->piece_list[side][i];
+        ui8 f = CB_SQUARE_FILE(square);
+        ui8 r = CB_SQUARE_RANK(square);
+
+        if(type != CB_EMPTY && CB_PIECE_TYPE(board->content[f][r]) != type)
+            continue;
+
+        switch(CB_PIECE_TYPE(board->content[f][r])) {
+            case CB_PAWN:
+                Movegen_pawn(gen, f, r);
+            break;
+
+            case CB_KNIGHT:
+                Movegen_targets(gen, square, CB_KNIGHT_ATTACKS(square) & ~CB_BB_COLOR(board, side), 0);
+            break;
+
+            case CB_BISHOP:
+                Movegen_targets(gen, square, CB_BISHOP_ATTACKS(square, occupied) & ~CB_BB_COLOR(board, side), 0);
+            break;
+
+            case CB_ROOK:
+                Movegen_targets(gen, square, CB_ROOK_ATTACKS(square, occupied) & ~CB_BB_COLOR(board, side), 0);
+            break;
+
+            case CB_QUEEN:
+                Movegen_targets(gen, square, CB_QUEEN_ATTACKS(square, occupied) & ~CB_BB_COLOR(board, side), 0);
+            break;
+
+            case CB_KING:
+                //King steps depend on defended fields, those go through the rules core
+                Movegen_targets(gen, square, CB_KING_ATTACKS(square) & ~CB_BB_COLOR(board, side), 1);
+
+                //Castling is encoded as the king moving onto its rook
+                if(f == CB_FILE_E && board->CB_ALLOW_DEFAULT_SPM && (kind & MOVEGEN_QUIET)) {
+                    Movegen_candidate(gen, f, r, CB_FILE_A, r, 0);
+                    Movegen_candidate(gen, f, r, CB_FILE_H, r, 0);
+                }
+            break;
+        }
+    }
+
+    return list->count;
+}
+
+/***** FUNCTIONALITY *****/
+
+/** @fn __UINT16_TYPE__ Board_generate_moves(const Board_t *board, BoardMoveList_t *list)
+ * @brief Generates every legal move of the side in turn. Every emitted move is accepted by Board_apply
+ * @param board Board to generate moves for
+ * @param list List to be filled, previous content is discarded
+ * @returns Number of legal moves
+ */
+__UINT16_TYPE__ Board_generate_moves(const Board_t *board, BoardMoveList_t *list) {
+    return Movegen_run(board, CB_TURN_COLOR(board), list, CB_MAX_MOVES, CB_EMPTY, MOVEGEN_ALL);
+}
+
+/** @fn ui8 Board_has_legal_move(const Board_t *board)
+ * @brief Checks if the side in turn has any legal move, stops at the first one found
+ * @param board Board to be checked
+ * @returns 1 - has a legal move || 0 - has none
+ */
+ui8 Board_has_legal_move(const Board_t *board) {
+    BoardMoveList_t list;
+    return Movegen_run(board, CB_TURN_COLOR(board), &list, 1, CB_EMPTY, MOVEGEN_ALL) != 0;
+}
+
+/** @fn __UINT16_TYPE__ Board_generate_piece_moves(const Board_t *board, BoardMoveList_t *list, ui8 type)
+ * @brief Generates the legal moves of the side in turn's pieces of one type only
+ * @param board Board to generate moves for
+ * @param list List to be filled, previous content is discarded
+ * @param type Piece type without color mask, e.g. CB_KNIGHT
+ * @returns Number of legal moves
+ */
+__UINT16_TYPE__ Board_generate_piece_moves(const Board_t *board, BoardMoveList_t *list, ui8 type) {
+    return Movegen_run(board, CB_TURN_COLOR(board), list, CB_MAX_MOVES, type, MOVEGEN_ALL);
+}
+
+/** @fn ui8 Board_color_has_legal_move(const Board_t *board, ui8 color)
+ * @brief Checks if a color has any legal move, regardless of whose turn it is
+ * @param board Board to be checked
+ * @param color 1 = white, 2 = black
+ * @returns 1 - has a legal move || 0 - has none
+ */
+ui8 Board_color_has_legal_move(const Board_t *board, ui8 color) {
+    BoardMoveList_t list;
+    return Movegen_run(board, color, &list, 1, CB_EMPTY, MOVEGEN_ALL) != 0;
+}
+
+/** @fn __UINT16_TYPE__ Board_generate_captures(const Board_t *board, BoardMoveList_t *list)
+ * @brief Generates the legal captures, en passant captures and promotions of the side in turn
+ * @param board Board to generate moves for
+ * @param list List to be filled, previous content is discarded
+ * @returns Number of legal moves
+ */
+__UINT16_TYPE__ Board_generate_captures(const Board_t *board, BoardMoveList_t *list) {
+    return Movegen_run(board, CB_TURN_COLOR(board), list, CB_MAX_MOVES, CB_EMPTY, MOVEGEN_NOISY);
+}
+
+/** @fn __UINT16_TYPE__ Board_generate_quiets(const Board_t *board, BoardMoveList_t *list)
+ * @brief Generates the legal moves of the side in turn that Board_generate_captures leaves out, castling included
+ * @param board Board to generate moves for
+ * @param list List to be filled, previous content is discarded
+ * @returns Number of legal moves
+ */
+__UINT16_TYPE__ Board_generate_quiets(const Board_t *board, BoardMoveList_t *list) {
+    return Movegen_run(board, CB_TURN_COLOR(board), list, CB_MAX_MOVES, CB_EMPTY, MOVEGEN_QUIET);
+}
+
+/** @fn ui8 Board_move_is_legal(const Board_t *board, BoardMove_t *move)
+ * @brief Checks a move from outside the generator, e.g. a table or killer move, for the side in turn without generating any other move
+ * @param board Board to be checked
+ * @param move Move to be checked, its code is filled in
+ * @returns Board_legal_move code || 0 - not legal in this position
+ */
+ui8 Board_move_is_legal(const Board_t *board, BoardMove_t *move) {
+    if(move->from_file > 7 || move->from_rank > 7)
+        return 0;
+    if(Board_color_field_p(board, move->from_file, move->from_rank) != CB_TURN_COLOR(board))
+        return 0;
+
+    move->code = Board_legal_move_p(board, *move);
+    if(!move->code)
+        return 0;
+
+    //King safety on a scratch copy, like Movegen_push
+    Board_t scratch;
+    BoardUndo_t records[1];
+    BoardUndoStack_t stack = CB_UNDO_STACK(records);
+    Board_clone_p(&scratch, board);
+    Board_make_move(&scratch, *move, &stack);
+    if(Board_in_check_p(&scratch, CB_TURN_COLOR(board)))
+        return move->code = 0;
+
+    return move->code;
+}
@@ -0,0 +1,309 @@
+/****************************************************
+ *  CHESS ENGINE by David Schoosleitner             *
+ * Date: 15.08.2022                                 *
+ * File: board_nnue.c                               *
+ ****************************************************
+ * Responsibilities:                                *
+ *  - neural network evaluation (optional)          *
+ *  - network file loading                          *
+ *  - accumulators, updated by board per piece      *
+ *  - AVX2 and SSE2 kernels, scalar fallback        *
+ *                                                  *
+ * Requires:                                        *
+ *  - board.c                                       *
+ ****************************************************/
+
+/***** INCLUDES *****/
+#include "board.h"
+#include <stdio.h>
+#include <string.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+    #include <immintrin.h>
+    #define NNUE_X86
+#endif
+
+/***** LOCAL CONSTANTS *****/
+#define NNUE_FEATURES (768)             /* Relative color (own, enemy) x piece type x square */
+#define NNUE_QA (255)                   /* Accumulator values are clipped to 0..QA before the output layer */
+#define NNUE_QB (64)                    /* Quantization of the output weights */
+#define NNUE_SCALE (400)                /* Output in centipawns is raw * SCALE / (QA * QB) */
+#define NNUE_MAGIC "CBNN"
+
+/***** LOCAL TYPES *****/
+typedef struct Nnue_t_s {
+    short feature_weights[NNUE_FEATURES][CB_NNUE_HIDDEN];
+    short feature_biases[CB_NNUE_HIDDEN];
+    short output_weights[2][CB_NNUE_HIDDEN];    /* Side in turn first, then the other side */
+    int output_bias;
+    ui8 loaded;
+} Nnue_t;
+
+/***** LOCAL STORAGE *****/
+static Nnue_t Nnue_network;             /* One network per process, read-only once loaded */
+
+static void (*Nnue_add)(short *, const short *);
+static void (*Nnue_sub)(short *, const short *);
+static int (*Nnue_output)(const short *, const short *, const short *);
+
+/***** LOCAL FUNCTIONALITY *****/
+
+/** @fn static void Nnue_add_scalar(short *acc, const short *weights)
+ * @brief Adds a feature's weight row to an accumulator, wraps around so every update can be undone exactly
+ */
+static void Nnue_add_scalar(short *acc, const short *weights) {
+    for(__UINT16_TYPE__ i = 0; i < CB_NNUE_HIDDEN; i++)
+        acc[i] = (short) (acc[i] + weights[i]);
+}
+
+/** @fn static void Nnue_sub_scalar(short *acc, const short *weights)
+ * @brief Subtracts a feature's weight row from an accumulator
+ */
+static void Nnue_sub_scalar(short *acc, const short *weights) {
+    for(__UINT16_TYPE__ i = 0; i < CB_NNUE_HIDDEN; i++)
+        acc[i] = (short) (acc[i] - weights[i]);
+}
+
+/** @fn static int Nnue_output_scalar(const short *us, const short *them, const short *weights)
+ * @brief Output layer, clipped accumulators of both sides times their weights
+ */
+static int Nnue_output_scalar(const short *us, const short *them, const short *weights) {
+    int sum = 0;
+    for(__UINT16_TYPE__ i = 0; i < CB_NNUE_HIDDEN; i++) {
+        int a = (us[i] < 0) ? 0 : ((us[i] > NNUE_QA) ? NNUE_QA : us[i]);
+        int b = (them[i] < 0) ? 0 : ((them[i] > NNUE_QA) ? NNUE_QA : them[i]);
+        sum += a * weights[i] + b * weights[CB_NNUE_HIDDEN + i];
+    }
+    return sum;
+}
+
+#ifdef NNUE_X86
+/** @fn static void Nnue_add_sse2(short *acc, const short *weights)
+ * @brief Nnue_add_scalar, 8 lanes at a time
+ */
+__attribute__((target("sse2")))
+static void Nnue_add_sse2(short *acc, const short *weights) {
+    for(__UINT16_TYPE__ i = 0; i < CB_NNUE_HIDDEN; i += 8) {
+        __m128i a = _mm_loadu_si128((const __m128i*) (acc + i));
+        __m128i w = _mm_loadu_si128((const __m128i*) (weights + i));
+        _mm_storeu_si128((__m128i*) (acc + i), _mm_add_epi16(a, w));
+    }
+}
+
+/** @fn static void Nnue_sub_sse2(short *acc, const short *weights)
+ * @brief Nnue_sub_scalar, 8 lanes at a time
+ */
+__attribute__((target("sse2")))
+static void Nnue_sub_sse2(short *acc, const short *weights) {
+    for(__UINT16_TYPE__ i = 0; i < CB_NNUE_HIDDEN; i += 8) {
+        __m128i a = _mm_loadu_si128((const __m128i*) (acc + i));
+        __m128i w = _mm_loadu_si128((const __m128i*) (weights + i));
+        _mm_storeu_si128((__m128i*) (acc + i), _mm_sub_epi16(a, w));
+    }
+}
+
+/** @fn static int Nnue_output_sse2(const short *us, const short *them, const short *weights)
+ * @brief Nnue_output_scalar, 8 lanes at a time, pairs of products summed by madd
+ */
+__attribute__((target("sse2")))
+static int Nnue_output_sse2(const short *us, const short *them, const short *weights) {
+    __m128i zero = _mm_setzero_si128();
+    __m128i qa = _mm_set1_epi16(NNUE_QA);
+    __m128i sum = _mm_setzero_si128();
+
+    for(__UINT16_TYPE__ i = 0; i < CB_NNUE_HIDDEN; i += 8) {
+        __m128i a = _mm_min_epi16(_mm_max_epi16(_mm_loadu_si128((const __m128i*) (us + i)), zero), qa);
+        __m128i b = _mm_min_epi16(_mm_max_epi16(_mm_loadu_si128((const __m128i*) (them + i)), zero), qa);
+        sum = _mm_add_epi32(sum, _mm_madd_epi16(a, _mm_loadu_si128((const __m128i*) (weights + i))));
+        sum = _mm_add_epi32(sum, _mm_madd_epi16(b, _mm_loadu_si128((const __m128i*) (weights + CB_NNUE_HIDDEN + i))));
+    }
+
+    //Horizontal sum of the 4 lanes
+    sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, 0x4E));
+    sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, 0xB1));
+    return _mm_cvtsi128_si32(sum);
+}
+
+/** @fn static void Nnue_add_avx2(short *acc, const short *weights)
+ * @brief Nnue_add_scalar, 16 lanes at a time
+ */
+__attribute__((target("avx2")))
+static void Nnue_add_avx2(short *acc, const short *weights) {
+    for(__UINT16_TYPE__ i = 0; i < CB_NNUE_HIDDEN; i += 16) {
+        __m256i a = _mm256_loadu_si256((const __m256i*) (acc + i));
+        __m256i w = _mm256_loadu_si256((const __m256i*) (weights + i));
+        _mm256_storeu_si256((__m256i*) (acc + i), _mm256_add_epi16(a, w));
+    }
+}
+
+/** @fn static void Nnue_sub_avx2(short *acc, const short *weights)
+ * @brief Nnue_sub_scalar, 16 lanes at a time
+ */
+__attribute__((target("avx2")))
+static void Nnue_sub_avx2(short *acc, const short *weights) {
+    for(__UINT16_TYPE__ i = 0; i < CB_NNUE_HIDDEN; i += 16) {
+        __m256i a = _mm256_loadu_si256((const __m256i*) (acc + i));
+        __m256i w = _mm256_loadu_si256((const __m256i*) (weights + i));
+        _mm256_storeu_si256((__m256i*) (acc + i), _mm256_sub_epi16(a, w));
+    }
+}
+
+/** @fn static int Nnue_output_avx2(const short *us, const short *them, const short *weights)
+ * @brief Nnue_output_scalar, 16 lanes at a time, pairs of products summed by madd
+ */
+__attribute__((target("avx2")))
+static int Nnue_output_avx2(const short *us, const short *them, const short *weights) {
+    __m256i zero = _mm256_setzero_si256();
+    __m256i qa = _mm256_set1_epi16(NNUE_QA);
+    __m256i sum = _mm256_setzero_si256();
+
+    for(__UINT16_TYPE__ i = 0; i < CB_NNUE_HIDDEN; i += 16) {
+        __m256i a = _mm256_min_epi16(_mm256_max_epi16(_mm256_loadu_si256((const __m256i*) (us + i)), zero), qa);
+        __m256i b = _mm256_min_epi16(_mm256_max_epi16(_mm256_loadu_si256((const __m256i*) (them + i)), zero), qa);
+        sum = _mm256_add_epi32(sum, _mm256_madd_epi16(a, _mm256_loadu_si256((const __m256i*) (weights + i))));
+        sum = _mm256_add_epi32(sum, _mm256_madd_epi16(b, _mm256_loadu_si256((const __m256i*) (weights + CB_NNUE_HIDDEN + i))));
+    }
+
+    //Horizontal sum of the 8 lanes
+    __m128i half = _mm_add_epi32(_mm256_castsi256_si128(sum), _mm256_extracti128_si256(sum, 1));
+    half = _mm_add_epi32(half, _mm_shuffle_epi32(half, 0x4E));
+    half = _mm_add_epi32(half, _mm_shuffle_epi32(half, 0xB1));
+    return _mm_cvtsi128_si32(half);
+}
+#endif
+
+/** @fn static void Nnue_select_kernels(void)
+ * @brief Picks the widest kernels the CPU supports, checked at run time so one binary runs everywhere
+ */
+static void Nnue_select_kernels(void) {
+    Nnue_add = Nnue_add_scalar;
+    Nnue_sub = Nnue_sub_scalar;
+    Nnue_output = Nnue_output_scalar;
+
+    #ifdef NNUE_X86
+    __builtin_cpu_init();
+    if(__builtin_cpu_supports("avx2")) {
+        Nnue_add = Nnue_add_avx2;
+        Nnue_sub = Nnue_sub_avx2;
+        Nnue_output = Nnue_output_avx2;
+    }
+    else if(__builtin_cpu_supports("sse2")) {
+        Nnue_add = Nnue_add_sse2;
+        Nnue_sub = Nnue_sub_sse2;
+        Nnue_output = Nnue_output_sse2;
+    }
+    #endif
+}
+
+/** @fn static __UINT16_TYPE__ Nnue_feature(ui8 perspective, ui8 piece, ui8 square)
+ * @brief Input index of a piece as seen by one side, the board is mirrored for black so both sides see themselves moving up
+ * @param perspective 0 = white, 1 = black
+ */
+static __UINT16_TYPE__ Nnue_feature(ui8 perspective, ui8 piece, ui8 square) {
+    ui8 relative = CB_PIECE_COLOR(piece) != perspective;
+    return ((relative * 6) + (CB_PIECE_TYPE(piece) - 1)) * 64 + (perspective ? square ^ 56 : square);
+}
+
+/***** FUNCTIONALITY *****/
+
+/** @fn ui8 Board_nnue_load(const char *path)
+ * @brief Loads a network. Layout, little endian: "CBNN", ui32 hidden size (must be CB_NNUE_HIDDEN), int16 feature
+ * @brief weights [768][hidden] ordered by own/enemy, piece type of board.h and square, int16 feature biases [hidden],
+ * @brief int16 output weights [2][hidden] for the side in turn and the other side, int32 output bias
+ * @param path Network file
+ * @returns is successful: 1 | else: 0, the previous network stays in place
+ */
+ui8 Board_nnue_load(const char *path) {
+    static Nnue_t loading;
+    char magic[4];
+    unsigned int hidden = 0;
+
+    FILE *file = fopen(path, "rb");
+    if(!file)
+        return 0;
+
+    ui8 ok = fread(magic, 1, 4, file) == 4 && !memcmp(magic, NNUE_MAGIC, 4) &&
+        fread(&hidden, sizeof(hidden), 1, file) == 1 && hidden == CB_NNUE_HIDDEN &&
+        fread(loading.feature_weights, sizeof(loading.feature_weights), 1, file) == 1 &&
+        fread(loading.feature_biases, sizeof(loading.feature_biases), 1, file) == 1 &&
+        fread(loading.output_weights, sizeof(loading.output_weights), 1, file) == 1 &&
+        fread(&loading.output_bias, sizeof(loading.output_bias), 1, file) == 1 &&
+        fgetc(file) == EOF;
+    fclose(file);
+
+    if(!ok)
+        return 0;
+
+    Nnue_select_kernels();
+    loading.loaded = 1;
+    Nnue_network = loading;
+    return 1;
+}
+
+/** @fn ui8 Board_nnue_ready(void)
+ * @brief Checks if a network is loaded
+ * @returns 1 - loaded || 0 - not
+ */
+ui8 Board_nnue_ready(void) {
+    return Nnue_network.loaded;
+}
+
+/** @fn ui8 Board_nnue_attach(Board_t *board, BoardAccumulator_t *acc)
+ * @brief Gives a board an accumulator, from then on every piece the board adds or removes updates it. One accumulator
+ * @brief belongs to exactly one board, clones don't inherit it
+ * @param board Board to evaluate with the network
+ * @param acc Accumulator, owned by the caller
+ * @returns 1 - attached || 0 - no network loaded, the board keeps the classical evaluation
+ */
+ui8 Board_nnue_attach(Board_t *board, BoardAccumulator_t *acc) {
+    if(!Nnue_network.loaded) {
+        board->nnue = NULL;
+        return 0;
+    }
+
+    board->nnue = acc;
+    Board_sync(board);
+    return 1;
+}
+
+/** @fn void Board_nnue_reset(BoardAccumulator_t *acc)
+ * @brief Sets an accumulator to the empty board, i.e. the feature biases
+ * @param acc Accumulator to be reset
+ * @returns none
+ */
+void Board_nnue_reset(BoardAccumulator_t *acc) {
+    memcpy(acc->values[0], Nnue_network.feature_biases, sizeof(Nnue_network.feature_biases));
+    memcpy(acc->values[1], Nnue_network.feature_biases, sizeof(Nnue_network.feature_biases));
+}
+
+/** @fn void Board_nnue_add(BoardAccumulator_t *acc, ui8 piece, ui8 square)
+ * @brief Adds a piece to both perspectives of an accumulator
+ * @param piece Piece including color mask
+ * @returns none
+ */
+void Board_nnue_add(BoardAccumulator_t *acc, ui8 piece, ui8 square) {
+    Nnue_add(acc->values[0], Nnue_network.feature_weights[Nnue_feature(0, piece, square)]);
+    Nnue_add(acc->values[1], Nnue_network.feature_weights[Nnue_feature(1, piece, square)]);
+}
+
+/** @fn void Board_nnue_remove(BoardAccumulator_t *acc, ui8 piece, ui8 square)
+ * @brief Removes a piece from both perspectives of an accumulator
+ * @param piece Piece including color mask
+ * @returns none
+ */
+void Board_nnue_remove(BoardAccumulator_t *acc, ui8 piece, ui8 square) {
+    Nnue_sub(acc->values[0], Nnue_network.feature_weights[Nnue_feature(0, piece, square)]);
+    Nnue_sub(acc->values[1], Nnue_network.feature_weights[Nnue_feature(1, piece, square)]);
+}
+
+/** @fn int Board_nnue_evaluate(const Board_t *board)
+ * @brief Network evaluation in centipawns from the view of the side in turn, only the output layer is computed here
+ * @param board Board with an attached accumulator
+ * @returns Score, positive if the side in turn is better
+ */
+int Board_nnue_evaluate(const Board_t *board) {
+    ui8 us = (board->turn == CB_TURN_WHITE) ? 0 : 1;
+    int raw = Nnue_output(board->nnue->values[us], board->nnue->values[1 - us], Nnue_network.output_weights[0]) +
+        Nnue_network.output_bias;
+    return (int) ((long long) raw * NNUE_SCALE / (NNUE_QA * NNUE_QB));
+}
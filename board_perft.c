@@ -0,0 +1,340 @@
+/****************************************************
+ *  CHESS ENGINE by David Schoosleitner             *
+ * Date: 15.08.2022                                 *
+ * File: board_perft.c                              *
+ ****************************************************
+ * Responsibilities:                                *
+ *  - perft, move generation node counting          *
+ *  - parallel perft on a work-stealing pool        *
+ *  - perft transposition cache                     *
+ *  - reference positions                           *
+ *                                                  *
+ * Requires:                                        *
+ *  - board_movegen.c                               *
+ ****************************************************/
+
+/***** INCLUDES *****/
+#include "board.h"
+#include <pthread.h>
+#include <stdlib.h>
+
+/***** LOCAL TYPES *****/
+typedef struct PerftSearch_t_s {
+    BoardUndoStack_t stack;         /* Undo stack of the searching thread */
+    BoardPerftCache_t *cache;       /* Shared cache or NULL */
+    ui64 hits;                      /* Cache statistics of this thread, added to the cache when done */
+    ui64 misses;
+} PerftSearch_t;
+
+typedef struct PerftTask_t_s {
+    Board_t board;                  /* Position after the split plies */
+    ui8 depth;                      /* Plies left below it */
+    ui64 nodes;                     /* Result */
+} PerftTask_t;
+
+typedef struct PerftWorker_t_s {
+    struct PerftPool_t_s *pool;
+    __UINT32_TYPE__ next;           /* Next own task, claimed atomically, thieves take from here as well */
+    __UINT32_TYPE__ end;            /* End of the own task range */
+    pthread_t thread;
+} PerftWorker_t;
+
+typedef struct PerftPool_t_s {
+    BoardPerftCache_t *cache;
+    PerftTask_t *tasks;
+    __UINT32_TYPE__ count;
+    __UINT32_TYPE__ capacity;
+    PerftWorker_t *workers;
+    unsigned int threads;
+} PerftPool_t;
+
+/***** GLOBAL TABLES *****/
+/* Well-known positions and leaf counts, depths kept small enough for a debug build */
+const BoardPerftCase_t Board_perft_cases[CB_PERFT_CASES] = {
+    {"rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1", 4, 197281ull},
+    {"r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1", 3, 97862ull},
+    {"8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1", 5, 674624ull},
+    {"r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1", 4, 422333ull},
+    {"rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8", 3, 62379ull},
+    {"r4rk1/1pp1qppp/p1np1n2/2b1p1B1/2B1P1b1/P1NP1N2/1PP1QPPP/R4RK1 w - - 0 10", 3, 89890ull},
+};
+
+/***** LOCAL FUNCTIONALITY *****/
+
+/** @fn static ui64 Perft_probe(PerftSearch_t *search, ui64 key, ui8 depth)
+ * @brief Looks up a subtree count, entries are checked against key and depth so torn writes of other threads are rejected
+ * @returns Leaf count || 0 - not cached
+ */
+static ui64 Perft_probe(PerftSearch_t *search, ui64 key, ui8 depth) {
+    BoardPerftEntry_t *entry = &search->cache->entries[key & (search->cache->size - 1)];
+    ui64 lock = __atomic_load_n(&entry->lock, __ATOMIC_RELAXED);
+    ui64 data = __atomic_load_n(&entry->data, __ATOMIC_RELAXED);
+
+    if((lock ^ data) == key && (data >> 56) == depth) {
+        search->hits++;
+        return data & 0x00FFFFFFFFFFFFFFull;
+    }
+    search->misses++;
+    return 0;
+}
+
+/** @fn static void Perft_store(PerftSearch_t *search, ui64 key, ui8 depth, ui64 nodes)
+ * @brief Stores a subtree count, always replacing
+ * @returns none
+ */
+static void Perft_store(PerftSearch_t *search, ui64 key, ui8 depth, ui64 nodes) {
+    BoardPerftEntry_t *entry = &search->cache->entries[key & (search->cache->size - 1)];
+    ui64 data = nodes | ((ui64) depth << 56);
+
+    __atomic_store_n(&entry->lock, key ^ data, __ATOMIC_RELAXED);
+    __atomic_store_n(&entry->data, data, __ATOMIC_RELAXED);
+}
+
+/** @fn static ui64 Perft_run(Board_t *board, PerftSearch_t *search, ui8 depth)
+ * @brief Counts leaves by making and unmaking every legal move in place, the last ply is counted without playing it
+ */
+static ui64 Perft_run(Board_t *board, PerftSearch_t *search, ui8 depth) {
+    //The last ply is cheaper to count than to look up
+    ui8 cached = search->cache && depth > 1;
+    if(cached) {
+        ui64 nodes = Perft_probe(search, board->key, depth);
+        if(nodes)
+            return nodes;
+    }
+
+    BoardMoveList_t list;
+    __UINT16_TYPE__ count = Board_generate_moves(board, &list);
+
+    if(depth <= 1)
+        return count;
+
+    ui64 nodes = 0;
+    for(__UINT16_TYPE__ i = 0; i < count; i++) {
+        Board_make_move(board, list.moves[i], &search->stack);
+        nodes += Perft_run(board, search, depth - 1);
+        Board_unmake_move(board, &search->stack);
+    }
+
+    if(cached && nodes)
+        Perft_store(search, board->key, depth, nodes);
+    return nodes;
+}
+
+/** @fn static void Perft_search_done(PerftSearch_t *search)
+ * @brief Adds the statistics of one thread to the cache
+ * @returns none
+ */
+static void Perft_search_done(PerftSearch_t *search) {
+    if(!search->cache)
+        return;
+    __atomic_fetch_add(&search->cache->hits, search->hits, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&search->cache->misses, search->misses, __ATOMIC_RELAXED);
+}
+
+/***** FUNCTIONALITY *****/
+
+/** @fn ui64 Board_perft(const Board_t *board, ui8 depth)
+ * @brief Counts the leaf positions of the legal move tree
+ * @param board Root position
+ * @param depth Plies, at most CB_PERFT_MAX_DEPTH
+ * @returns Number of leaves, 1 for depth 0
+ */
+ui64 Board_perft(const Board_t *board, ui8 depth) {
+    return Board_perft_cached(board, depth, 1, NULL);
+}
+
+/** @fn __UINT16_TYPE__ Board_perft_divide(const Board_t *board, ui8 depth, BoardMoveList_t *list, ui64 *counts)
+ * @brief Perft split by root move, for finding the move a generator bug hides behind
+ * @param board Root position
+ * @param depth Plies including the root move, at least 1
+ * @param list Filled with the root moves
+ * @param counts Leaves per root move, CB_MAX_MOVES entries
+ * @returns Number of root moves
+ */
+__UINT16_TYPE__ Board_perft_divide(const Board_t *board, ui8 depth, BoardMoveList_t *list, ui64 *counts) {
+    Board_t scratch;
+    BoardUndo_t records[CB_PERFT_MAX_DEPTH];
+    PerftSearch_t search = {.stack = CB_UNDO_STACK(records), .cache = NULL};
+
+    if(depth == 0)
+        depth = 1;
+    if(depth > CB_PERFT_MAX_DEPTH)
+        depth = CB_PERFT_MAX_DEPTH;
+
+    Board_clone_p(&scratch, board);
+    Board_generate_moves(&scratch, list);
+
+    for(__UINT16_TYPE__ i = 0; i < list->count; i++) {
+        Board_make_move(&scratch, list->moves[i], &search.stack);
+        counts[i] = (depth > 1) ? Perft_run(&scratch, &search, depth - 1) : 1;
+        Board_unmake_move(&scratch, &search.stack);
+    }
+
+    return list->count;
+}
+
+/** @fn static ui8 Perft_split(PerftPool_t *pool, Board_t *board, BoardUndoStack_t *stack, ui8 plies, ui8 depth)
+ * @brief Collects the positions after the first plies as tasks, or the leaf count if the tree ends early
+ * @returns 1 - done || 0 - out of memory, board is restored and the tasks so far are kept
+ */
+static ui8 Perft_split(PerftPool_t *pool, Board_t *board, BoardUndoStack_t *stack, ui8 plies, ui8 depth) {
+    if(plies == 0) {
+        if(pool->count == pool->capacity) {
+            PerftTask_t *tasks = (PerftTask_t*) realloc(pool->tasks, pool->capacity * 2 * sizeof(PerftTask_t));
+            if(!tasks)
+                return 0;
+            pool->tasks = tasks;
+            pool->capacity *= 2;
+        }
+
+        PerftTask_t *task = &pool->tasks[pool->count++];
+        Board_clone_p(&task->board, board);
+        task->depth = depth;
+        task->nodes = 0;
+        return 1;
+    }
+
+    BoardMoveList_t list;
+    Board_generate_moves(board, &list);
+    for(__UINT16_TYPE__ i = 0; i < list.count; i++) {
+        Board_make_move(board, list.moves[i], stack);
+        ui8 done = Perft_split(pool, board, stack, plies - 1, depth - 1);
+        Board_unmake_move(board, stack);
+        if(!done)
+            return 0;
+    }
+    return 1;
+}
+
+/** @fn static void *Perft_worker(void *arg)
+ * @brief Works through the own task range, then steals the remaining tasks of other workers
+ * @returns NULL
+ */
+static void *Perft_worker(void *arg) {
+    PerftWorker_t *self = (PerftWorker_t*) arg;
+    PerftPool_t *pool = self->pool;
+    BoardUndo_t records[CB_PERFT_MAX_DEPTH];
+    PerftSearch_t search = {.stack = CB_UNDO_STACK(records), .cache = pool->cache, .hits = 0, .misses = 0};
+
+    //Own range first, then every other worker's, starting with the next one
+    unsigned int index = self - pool->workers;
+    for(unsigned int w = 0; w < pool->threads; w++) {
+        PerftWorker_t *victim = &pool->workers[(index + w) % pool->threads];
+
+        for(;;) {
+            __UINT32_TYPE__ t = __atomic_fetch_add(&victim->next, 1, __ATOMIC_RELAXED);
+            if(t >= victim->end)
+                break;
+
+            PerftTask_t *task = &pool->tasks[t];
+            task->nodes = Perft_run(&task->board, &search, task->depth);
+        }
+    }
+
+    Perft_search_done(&search);
+    return NULL;
+}
+
+/** @fn ui64 Board_perft_parallel(const Board_t *board, ui8 depth, unsigned int threads)
+ * @brief Perft split at the first plies, the subtrees are counted on a work-stealing pool
+ * @param board Root position
+ * @param depth Plies, at most CB_PERFT_MAX_DEPTH
+ * @param threads Number of worker threads, 1 runs Board_perft
+ * @returns Number of leaves, same as Board_perft
+ */
+ui64 Board_perft_parallel(const Board_t *board, ui8 depth, unsigned int threads) {
+    return Board_perft_cached(board, depth, threads, NULL);
+}
+
+/** @fn ui64 Board_perft_cached(const Board_t *board, ui8 depth, unsigned int threads, BoardPerftCache_t *cache)
+ * @brief Perft on any number of threads, transposed subtrees are looked up in a cache shared by all threads.
+ * @brief Falls back to a single thread if the task pool can't be allocated
+ * @param board Root position
+ * @param depth Plies, at most CB_PERFT_MAX_DEPTH
+ * @param threads Number of worker threads, at most CB_MAX_THREADS
+ * @param cache Cache from Board_perft_cache_init, may be reused across calls || NULL - no cache
+ * @returns Number of leaves, same as Board_perft
+ */
+ui64 Board_perft_cached(const Board_t *board, ui8 depth, unsigned int threads, BoardPerftCache_t *cache) {
+    Board_t scratch;
+    BoardUndo_t records[CB_PERFT_MAX_DEPTH];
+
+    if(depth == 0)
+        return 1;
+    if(depth > CB_PERFT_MAX_DEPTH)
+        depth = CB_PERFT_MAX_DEPTH;
+    if(threads > CB_MAX_THREADS)
+        threads = CB_MAX_THREADS;
+
+    Board_clone_p(&scratch, board);
+
+    BoardUndoStack_t stack = CB_UNDO_STACK(records);
+    PerftPool_t pool = {.cache = cache, .tasks = NULL, .count = 0, .capacity = 1024, .workers = NULL, .threads = threads};
+
+    //Step 1: Two plies give enough subtrees to balance, the last ply is always left to the tasks
+    if(threads > 1 && depth >= 3) {
+        pool.tasks = (PerftTask_t*) malloc(pool.capacity * sizeof(PerftTask_t));
+        pool.workers = (PerftWorker_t*) malloc(threads * sizeof(PerftWorker_t));
+    }
+
+    //Single thread, no split, also if there's no memory for the pool
+    if(!pool.tasks || !pool.workers || !Perft_split(&pool, &scratch, &stack, (depth > 3) ? 2 : 1, depth)) {
+        free(pool.tasks);
+        free(pool.workers);
+
+        PerftSearch_t search = {.stack = CB_UNDO_STACK(records), .cache = cache, .hits = 0, .misses = 0};
+        ui64 nodes = Perft_run(&scratch, &search, depth);
+        Perft_search_done(&search);
+        return nodes;
+    }
+
+    //Step 2: Hand out contiguous ranges, run
+    for(unsigned int w = 0; w < threads; w++) {
+        pool.workers[w].pool = &pool;
+        pool.workers[w].next = (__UINT32_TYPE__) ((ui64) pool.count * w / threads);
+        pool.workers[w].end = (__UINT32_TYPE__) ((ui64) pool.count * (w + 1) / threads);
+    }
+    for(unsigned int w = 1; w < threads; w++)
+        pthread_create(&pool.workers[w].thread, NULL, Perft_worker, &pool.workers[w]);
+    Perft_worker(&pool.workers[0]);
+    for(unsigned int w = 1; w < threads; w++)
+        pthread_join(pool.workers[w].thread, NULL);
+
+    //Step 3: Sum up
+    ui64 nodes = 0;
+    for(__UINT32_TYPE__ t = 0; t < pool.count; t++)
+        nodes += pool.tasks[t].nodes;
+
+    free(pool.tasks);
+    free(pool.workers);
+    return nodes;
+}
+
+/** @fn ui8 Board_perft_cache_init(BoardPerftCache_t *cache, __SIZE_TYPE__ megabytes)
+ * @brief Allocates an empty perft cache, the entry count is the largest power of two within the budget
+ * @param cache Cache to be initialized
+ * @param megabytes Memory budget, at least 1
+ * @returns is successful: 1 | else: 0
+ */
+ui8 Board_perft_cache_init(BoardPerftCache_t *cache, __SIZE_TYPE__ megabytes) {
+    __SIZE_TYPE__ size = 1;
+    while(size * 2 * sizeof(BoardPerftEntry_t) <= megabytes * 1024 * 1024)
+        size *= 2;
+
+    cache->entries = (BoardPerftEntry_t*) calloc(size, sizeof(BoardPerftEntry_t));
+    cache->size = cache->entries ? size : 0;
+    cache->hits = 0;
+    cache->misses = 0;
+    return cache->entries != NULL;
+}
+
+/** @fn void Board_perft_cache_free(BoardPerftCache_t *cache)
+ * @brief Releases a perft cache
+ * @param cache Cache to be freed
+ * @returns none
+ */
+void Board_perft_cache_free(BoardPerftCache_t *cache) {
+    free(cache->entries);
+    cache->entries = NULL;
+    cache->size = 0;
+}
@@ -0,0 +1,794 @@
+/****************************************************
+ *  CHESS ENGINE by David Schoosleitner             *
+ * Date: 15.08.2022                                 *
+ * File: board_search.c                             *
+ ****************************************************
+ * Responsibilities:                                *
+ *  - alpha-beta search, iterative deepening        *
+ *  - staged move picking and ordering              *
+ *  - quiescence search of captures                 *
+ *  - null move, late move reductions, futility     *
+ *  - evaluation through the evaluation cache       *
+ *  - lazy SMP, threads sharing one table           *
+ *  - time budgets, watchdog for the hard deadline  *
+ *                                                  *
+ * Requires:                                        *
+ *  - board_movegen.c                               *
+ *  - board_eval.c                                  *
+ *  - board_tt.c                                    *
+ *  - board_eval_cache.c                            *
+ *  - board_time.c                                  *
+ ****************************************************/
+
+/***** INCLUDES *****/
+#include "board.h"
+#include <math.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+/***** LOCAL CONSTANTS *****/
+#define SEARCH_NODE_BATCH (1024)                /* Nodes a thread counts before adding them to the shared count */
+#define SEARCH_PAWN_TABLE_KB (512)              /* Pawn table of every thread */
+
+#define SEARCH_HISTORY_MAX (80000)               /* History counters are halved beyond this */
+#define SEARCH_DELTA_MARGIN (200)               /* Quiescence skips captures that can't lift the score to alpha even with this much on top */
+#define SEARCH_REVERSE_DEPTH (3)                /* Reverse futility pruning up to this depth */
+#define SEARCH_REVERSE_MARGIN (120)             /* ... if the evaluation beats beta by this much per ply */
+#define SEARCH_FUTILITY_DEPTH (3)               /* Futility pruning up to this depth, margins in Search_futility_margin */
+#define SEARCH_NULL_DEPTH (3)                   /* Null move pruning from this depth on */
+#define SEARCH_NULL_VERIFY (2)                  /* Null move cutoffs are verified with this many pieces or less besides king and pawns */
+#define SEARCH_LMR_DEPTH (3)                    /* Late move reductions from this depth on */
+#define SEARCH_LMR_MOVES (3)                    /* ... for moves after this many */
+#define SEARCH_MATE_BOUND (CB_SCORE_MATE - CB_MAX_PLY)  /* Scores beyond are mates */
+
+#define SEARCH_PICK_TT (0)                      /* Move picker stages, each one is only entered once the previous one ran dry */
+#define SEARCH_PICK_CAPTURES_GEN (1)
+#define SEARCH_PICK_CAPTURES (2)
+#define SEARCH_PICK_KILLERS (3)
+#define SEARCH_PICK_QUIETS_GEN (4)
+#define SEARCH_PICK_QUIETS (5)
+#define SEARCH_PICK_BAD_CAPTURES (6)
+#define SEARCH_PICK_DONE (7)
+
+static const int Search_futility_margin[SEARCH_FUTILITY_DEPTH + 1] = {0, 150, 300, 450};
+
+/***** LOCAL TYPES *****/
+typedef struct SearchShared_t_s {
+    const Board_t *root;                        /* Position to be searched */
+    BoardTT_t *tt;                              /* Table shared by all threads */
+    BoardEvalCache_t *evals;                    /* Evaluation cache shared by all threads, may be NULL */
+    ui64 nodes;                                 /* Nodes of all threads, added in batches */
+    ui64 node_limit;                            /* Stop after this many nodes, 0 = none */
+    ui8 max_depth;                              /* Deepest iteration */
+    ui8 disabled;                               /* CB_PRUNE_* switched off */
+    ui8 reductions[CB_MAX_PLY][64];             /* Late move reduction by depth and move number */
+    ui8 stop;                                   /* Set once a limit is hit or the main thread is done */
+} SearchShared_t;
+
+typedef struct Search_t_s {
+    SearchShared_t *shared;
+    unsigned int id;                            /* Thread index, 0 = main thread, reports the result */
+    Board_t board;                              /* Position, moves are made and unmade in place */
+    BoardUndo_t records[CB_MAX_PLY];
+    BoardUndoStack_t stack;
+    ui64 nodes;                                 /* Nodes not yet added to the shared count */
+    BoardMove_t pv[CB_MAX_PLY][CB_MAX_PLY];     /* Triangular principal variation table */
+    ui8 pv_length[CB_MAX_PLY];
+    BoardMove_t killers[CB_MAX_PLY][2];         /* Quiet moves that caused a cutoff at this ply, newest first */
+    int history[2][7][64];                      /* Quiet move cutoffs by color, piece type and target square */
+    BoardPawnTable_t pawns;                     /* Own pawn table, threads don't share it */
+    BoardAccumulator_t acc;                     /* Network accumulator of board, if a network is loaded */
+    ui64 eval_hits;                             /* Evaluation cache statistics, added to the cache at the end */
+    ui64 eval_misses;
+    pthread_t thread;
+} Search_t;
+
+typedef struct SearchWatchdog_t_s {
+    ui8 *stop;                                  /* SearchShared_t.stop */
+    ui64 deadline;                              /* Board_time_now at which the search is stopped */
+    ui8 done;                                   /* Set by the search when it ended before the deadline */
+    pthread_mutex_t lock;
+    pthread_cond_t wake;                        /* Signalled when done is set */
+    pthread_t thread;
+} SearchWatchdog_t;
+
+typedef struct SearchPicker_t_s {
+    ui8 stage;                                  /* SEARCH_PICK_* */
+    BoardMove_t tt_move;                        /* Table move, code 0 = none */
+    BoardMove_t killers[2];
+    ui8 killer_index;                           /* Next killer to try */
+    ui8 killer_played[2];                       /* Killers handed out, skipped by the quiet stage */
+    BoardMoveList_t captures;                   /* Captures and promotions, the bad ones stay behind for the last stage */
+    int capture_order[CB_MAX_MOVES];
+    __UINT16_TYPE__ capture_index;
+    __UINT16_TYPE__ bad_index;
+    BoardMoveList_t quiets;
+    int quiet_order[CB_MAX_MOVES];
+    __UINT16_TYPE__ quiet_index;
+} SearchPicker_t;
+
+/***** LOCAL FUNCTIONALITY *****/
+
+/** @fn static ui8 Search_same_move(BoardMove_t a, BoardMove_t b)
+ * @brief Compares moves without their code
+ */
+static ui8 Search_same_move(BoardMove_t a, BoardMove_t b) {
+    return a.from_file == b.from_file && a.from_rank == b.from_rank && a.to_file == b.to_file &&
+        a.to_rank == b.to_rank && a.special == b.special;
+}
+
+/** @fn static ui8 Search_stopped(Search_t *search)
+ * @brief Counts a node and checks the limits, the shared node count is only touched once per batch
+ */
+static ui8 Search_stopped(Search_t *search) {
+    SearchShared_t *shared = search->shared;
+
+    if(++search->nodes >= SEARCH_NODE_BATCH) {
+        ui64 total = __atomic_add_fetch(&shared->nodes, search->nodes, __ATOMIC_RELAXED);
+        search->nodes = 0;
+        if(shared->node_limit && total >= shared->node_limit)
+            __atomic_store_n(&shared->stop, 1, __ATOMIC_RELAXED);
+    }
+
+    return __atomic_load_n(&shared->stop, __ATOMIC_RELAXED);
+}
+
+/** @fn static ui8 Search_is_quiet(const Board_t *board, BoardMove_t move)
+ * @brief Checks if a move neither captures nor promotes
+ */
+static ui8 Search_is_quiet(const Board_t *board, BoardMove_t move) {
+    return Board_move_victim(board, move) == CB_EMPTY && !CB_IS_PROMOTION(move.code);
+}
+
+/** @fn static int Search_capture_order(const Board_t *board, BoardMove_t move)
+ * @brief Most valuable victim first, least valuable attacker second, the king attacks last. Negative for captures
+ * @brief that lose material in the exchange (Board_see) and for underpromotions that don't capture, those are tried
+ * @brief after the quiet moves
+ */
+static int Search_capture_order(const Board_t *board, BoardMove_t move) {
+    ui8 victim = Board_move_victim(board, move);
+    ui8 attacker = CB_PIECE_TYPE(board->content[move.from_file][move.from_rank]);
+    int order = 10 * Board_piece_values[victim] + ((move.code == 11) ? 10 * Board_piece_values[CB_QUEEN] : 0) -
+        ((attacker == CB_KING) ? 1000 : Board_piece_values[attacker]) / 10 + 1000;
+
+    //Promoting to anything but a queen is only worth it in rare positions, unless it takes a piece on the way
+    if(CB_IS_PROMOTION(move.code) && move.code != 11 && victim == CB_EMPTY)
+        return order - 20000;
+
+    //Taking a piece worth at least the attacker can't lose material, the exchange is only played out otherwise
+    if(!CB_IS_PROMOTION(move.code) && Board_piece_values[attacker] > Board_piece_values[victim] && Board_see(board, move) < 0)
+        return order - 20000;
+    return order;
+}
+
+/** @fn static int Search_pick_best(BoardMoveList_t *list, int *order, __UINT16_TYPE__ index)
+ * @brief Selection step, swaps the highest ordered move from index on to index
+ * @returns Order of the picked move
+ */
+static int Search_pick_best(BoardMoveList_t *list, int *order, __UINT16_TYPE__ index) {
+    __UINT16_TYPE__ pick = index;
+    for(__UINT16_TYPE__ j = index + 1; j < list->count; j++)
+        if(order[j] > order[pick])
+            pick = j;
+
+    if(pick != index) {
+        BoardMove_t swap = list->moves[index];
+        list->moves[index] = list->moves[pick];
+        list->moves[pick] = swap;
+        int swap_order = order[index];
+        order[index] = order[pick];
+        order[pick] = swap_order;
+    }
+    return order[index];
+}
+
+/** @fn static void Search_picker_init(Search_t *search, SearchPicker_t *picker, ui8 ply, const BoardTTData_t *tt_entry)
+ * @brief Prepares the move picker of a node, nothing is generated yet
+ * @param tt_entry Table entry of the node, NULL on a miss
+ */
+static void Search_picker_init(Search_t *search, SearchPicker_t *picker, ui8 ply, const BoardTTData_t *tt_entry) {
+    picker->stage = SEARCH_PICK_TT;
+    picker->tt_move = tt_entry ? tt_entry->move : (BoardMove_t) {0};
+    picker->killers[0] = search->killers[ply][0];
+    picker->killers[1] = search->killers[ply][1];
+    picker->killer_index = 0;
+    picker->killer_played[0] = picker->killer_played[1] = 0;
+}
+
+/** @fn static ui8 Search_pick(Search_t *search, SearchPicker_t *picker, BoardMove_t *move)
+ * @brief Hands out the moves of a node in stages: table move, good captures, killers, quiet moves by history, bad captures.
+ * @brief The capture and quiet lists are only generated once their stage is reached, most nodes cut off before
+ * @param move Next move, with its code
+ * @returns 1 - move set || 0 - no moves left
+ */
+static ui8 Search_pick(Search_t *search, SearchPicker_t *picker, BoardMove_t *move) {
+    Board_t *board = &search->board;
+
+    switch(picker->stage) {
+        case SEARCH_PICK_TT:
+            picker->stage = SEARCH_PICK_CAPTURES_GEN;
+            if(picker->tt_move.code && Board_move_is_legal(board, &picker->tt_move)) {
+                *move = picker->tt_move;
+                return 1;
+            }
+            picker->tt_move.code = 0;
+            //fall through
+
+        case SEARCH_PICK_CAPTURES_GEN:
+            Board_generate_captures(board, &picker->captures);
+            for(__UINT16_TYPE__ i = 0; i < picker->captures.count; i++)
+                picker->capture_order[i] = Search_capture_order(board, picker->captures.moves[i]);
+            picker->capture_index = 0;
+            picker->stage = SEARCH_PICK_CAPTURES;
+            //fall through
+
+        case SEARCH_PICK_CAPTURES:
+            while(picker->capture_index < picker->captures.count) {
+                if(Search_pick_best(&picker->captures, picker->capture_order, picker->capture_index) < 0)
+                    break;
+                *move = picker->captures.moves[picker->capture_index++];
+                if(picker->tt_move.code && Search_same_move(*move, picker->tt_move))
+                    continue;
+                return 1;
+            }
+            picker->bad_index = picker->capture_index;
+            picker->stage = SEARCH_PICK_KILLERS;
+            //fall through
+
+        case SEARCH_PICK_KILLERS:
+            //Killers come from sibling positions, each one has to be checked here
+            while(picker->killer_index < 2) {
+                ui8 k = picker->killer_index++;
+                *move = picker->killers[k];
+
+                if(!move->code || (picker->tt_move.code && Search_same_move(*move, picker->tt_move)))
+                    continue;
+                if(Board_move_is_legal(board, move) && Search_is_quiet(board, *move)) {
+                    picker->killer_played[k] = 1;
+                    return 1;
+                }
+            }
+            picker->stage = SEARCH_PICK_QUIETS_GEN;
+            //fall through
+
+        case SEARCH_PICK_QUIETS_GEN:
+            Board_generate_quiets(board, &picker->quiets);
+            for(__UINT16_TYPE__ i = 0; i < picker->quiets.count; i++) {
+                BoardMove_t quiet = picker->quiets.moves[i];
+                ui8 piece = CB_PIECE_TYPE(board->content[quiet.from_file][quiet.from_rank]);
+                picker->quiet_order[i] = search->history[board->turn][piece][Board_move_target(board, quiet)];
+            }
+            picker->quiet_index = 0;
+            picker->stage = SEARCH_PICK_QUIETS;
+            //fall through
+
+        case SEARCH_PICK_QUIETS:
+            while(picker->quiet_index < picker->quiets.count) {
+                Search_pick_best(&picker->quiets, picker->quiet_order, picker->quiet_index);
+                *move = picker->quiets.moves[picker->quiet_index++];
+                if(picker->tt_move.code && Search_same_move(*move, picker->tt_move))
+                    continue;
+                if((picker->killer_played[0] && Search_same_move(*move, picker->killers[0])) ||
+                    (picker->killer_played[1] && Search_same_move(*move, picker->killers[1])))
+                    continue;
+                return 1;
+            }
+            picker->stage = SEARCH_PICK_BAD_CAPTURES;
+            //fall through
+
+        case SEARCH_PICK_BAD_CAPTURES:
+            //Left behind in order by the capture stage
+            while(picker->bad_index < picker->captures.count) {
+                Search_pick_best(&picker->captures, picker->capture_order, picker->bad_index);
+                *move = picker->captures.moves[picker->bad_index++];
+                if(picker->tt_move.code && Search_same_move(*move, picker->tt_move))
+                    continue;
+                return 1;
+            }
+            picker->stage = SEARCH_PICK_DONE;
+            //fall through
+
+        default:
+            return 0;
+    }
+}
+
+/** @fn static void Search_cutoff(Search_t *search, BoardMove_t move, ui8 depth, ui8 ply)
+ * @brief Remembers a quiet move that caused a beta cutoff as killer and in the history
+ */
+static void Search_cutoff(Search_t *search, BoardMove_t move, ui8 depth, ui8 ply) {
+    Board_t *board = &search->board;
+
+    if(!Search_is_quiet(board, move))
+        return;
+
+    if(!Search_same_move(move, search->killers[ply][0])) {
+        search->killers[ply][1] = search->killers[ply][0];
+        search->killers[ply][0] = move;
+    }
+
+    //Halve everything once a counter gets large so it stays below the killers
+    int *h = &search->history[board->turn][CB_PIECE_TYPE(board->content[move.from_file][move.from_rank])][Board_move_target(board, move)];
+    *h += depth * depth;
+    if(*h > SEARCH_HISTORY_MAX) {
+        int *all = &search->history[0][0][0];
+        for(__UINT16_TYPE__ i = 0; i < 2 * 7 * 64; i++)
+            all[i] /= 2;
+    }
+}
+
+/** @fn static int Search_evaluate(Search_t *search)
+ * @brief Static evaluation of the current position, taken from the evaluation cache if it was evaluated before
+ * @returns Score from the view of the side in turn
+ */
+static int Search_evaluate(Search_t *search) {
+    BoardEvalCache_t *evals = search->shared->evals;
+    int score;
+
+    if(!evals)
+        return Board_evaluate(&search->board, &search->pawns);
+
+    if(Board_eval_cache_probe(evals, search->board.key, &score)) {
+        search->eval_hits++;
+        return score;
+    }
+
+    search->eval_misses++;
+    score = Board_evaluate(&search->board, &search->pawns);
+    Board_eval_cache_store(evals, search->board.key, score);
+    return score;
+}
+
+/** @fn static int Search_quiesce(Search_t *search, int alpha, int beta, ui8 ply)
+ * @brief Capture search at the horizon so the evaluation is only taken in quiet positions. The side in turn may stand pat
+ * @brief on the evaluation instead of capturing, captures that can't reach alpha are pruned (delta pruning). In check
+ * @brief every evasion is searched
+ * @returns Score from the view of the side in turn
+ */
+static int Search_quiesce(Search_t *search, int alpha, int beta, ui8 ply) {
+    Board_t *board = &search->board;
+    search->pv_length[ply] = ply;
+
+    if(Search_stopped(search))
+        return 0;
+
+    ui8 check = Board_in_check_p(board, CB_TURN_COLOR(board));
+    int stand_pat = Search_evaluate(search);
+    if(ply >= CB_MAX_PLY - 1)
+        return stand_pat;
+
+    //Step 1: Stand pat, not possible in check
+    if(!check) {
+        if(stand_pat >= beta)
+            return stand_pat;
+        if(stand_pat > alpha)
+            alpha = stand_pat;
+    }
+
+    //Step 2: Captures, en passant and promotions as the rules core codes them, evasions in check
+    BoardMoveList_t list;
+    int order[CB_MAX_MOVES];
+    if(check)
+        Board_generate_moves(board, &list);
+    else
+        Board_generate_captures(board, &list);
+
+    if(!list.count)
+        return check ? -CB_SCORE_MATE + ply : alpha;
+
+    for(__UINT16_TYPE__ i = 0; i < list.count; i++)
+        order[i] = Search_is_quiet(board, list.moves[i]) ? -30000 : Search_capture_order(board, list.moves[i]);
+
+    //Step 3: Best capture first, hopeless ones skipped, captures losing the exchange end the search
+    for(__UINT16_TYPE__ i = 0; i < list.count; i++) {
+        if(Search_pick_best(&list, order, i) < 0 && !check)
+            break;
+        BoardMove_t move = list.moves[i];
+
+        if(!check) {
+            int gain = Board_piece_values[Board_move_victim(board, move)];
+            if(CB_IS_PROMOTION(move.code))
+                gain += Board_piece_values[CB_PROMOTION_PIECE(move.code)] - Board_piece_values[CB_PAWN];
+            if(stand_pat + gain + SEARCH_DELTA_MARGIN <= alpha)
+                continue;
+        }
+
+        Board_make_move(board, move, &search->stack);
+        int score = -Search_quiesce(search, -beta, -alpha, ply + 1);
+        Board_unmake_move(board, &search->stack);
+        if(__atomic_load_n(&search->shared->stop, __ATOMIC_RELAXED))
+            return 0;
+
+        if(score > alpha) {
+            alpha = score;
+            if(alpha >= beta)
+                break;
+        }
+    }
+
+    return alpha;
+}
+
+/** @fn static int Search_negamax(Search_t *search, int alpha, int beta, int depth, ui8 ply, ui8 allow_null)
+ * @brief Principal variation search: the first move gets the full window, the others a null window and are re-searched if they beat alpha.
+ * @brief Outside of the principal variation it prunes selectively: reverse futility and null move cutoffs before the moves,
+ * @brief futility pruning of quiet moves near the leaves and reduced depth for late quiet moves, each one switchable by CB_PRUNE_*
+ * @param allow_null 0 right after a null move and while verifying one
+ * @returns Score from the view of the side in turn
+ */
+static int Search_negamax(Search_t *search, int alpha, int beta, int depth, ui8 ply, ui8 allow_null) {
+    Board_t *board = &search->board;
+    SearchShared_t *shared = search->shared;
+    BoardTT_t *tt = shared->tt;
+
+    if(depth <= 0 || ply >= CB_MAX_PLY - 1)
+        return Search_quiesce(search, alpha, beta, ply);
+
+    search->pv_length[ply] = ply;
+    if(Search_stopped(search))
+        return 0;
+
+    //Step 1: Transposition table, cutoffs only outside of the principal variation so it stays complete
+    int alpha_start = alpha;
+    ui8 pv_node = beta - alpha > 1;
+    BoardTTData_t entry;
+    ui8 hit = Board_tt_probe(tt, board->key, &entry);
+    if(hit && ply > 0 && !pv_node && entry.depth >= depth) {
+        int score = entry.score;
+        if(score > SEARCH_MATE_BOUND) score -= ply;
+        if(score < -SEARCH_MATE_BOUND) score += ply;
+
+        if(entry.bound == CB_BOUND_EXACT ||
+            (entry.bound == CB_BOUND_LOWER && score >= beta) ||
+            (entry.bound == CB_BOUND_UPPER && score <= alpha))
+            return score;
+    }
+
+    //Step 2: Static evaluation for the pruning decisions, never in check or on the principal variation
+    ui8 check = Board_in_check_p(board, CB_TURN_COLOR(board));
+    ui8 selective = !pv_node && !check && ply > 0;
+    int eval = selective ? Search_evaluate(search) : 0;
+
+    //Step 3: Reverse futility, so far above beta near the leaves that no move will drop below it
+    if(selective && !(shared->disabled & CB_PRUNE_REVERSE) && depth <= SEARCH_REVERSE_DEPTH && beta < SEARCH_MATE_BOUND &&
+        eval - SEARCH_REVERSE_MARGIN * depth >= beta)
+        return eval;
+
+    //Step 4: Null move, if passing still beats beta a real move will too. Fails when passing would help (zugzwang),
+    //so with only a few pieces left a cutoff is confirmed by a reduced search without null moves
+    ui8 own = (board->turn == CB_TURN_WHITE) ? 0 : 1;
+    ui64 pieces = CB_BB_COLOR(board, own) & ~CB_BB_PIECE(board, own, CB_PAWN) & ~CB_BB_PIECE(board, own, CB_KING);
+    if(selective && allow_null && !(shared->disabled & CB_PRUNE_NULL) && depth >= SEARCH_NULL_DEPTH && pieces &&
+        eval >= beta && beta < SEARCH_MATE_BOUND) {
+        int null_depth = depth - 1 - (3 + depth / 6);
+
+        Board_make_null_move(board, &search->stack);
+        int score = -Search_negamax(search, -beta, -beta + 1, null_depth, ply + 1, 0);
+        Board_unmake_move(board, &search->stack);
+        if(__atomic_load_n(&shared->stop, __ATOMIC_RELAXED))
+            return 0;
+
+        if(score >= beta) {
+            if(score >= SEARCH_MATE_BOUND)
+                score = beta;
+            if(CB_POPCOUNT(pieces) > SEARCH_NULL_VERIFY || Search_negamax(search, beta - 1, beta, null_depth, ply, 0) >= beta)
+                return score;
+            search->pv_length[ply] = ply;
+        }
+    }
+
+    //Step 5: Futility, quiet moves can't lift a hopeless evaluation to alpha near the leaves
+    ui8 futile = selective && !(shared->disabled & CB_PRUNE_FUTILITY) && depth <= SEARCH_FUTILITY_DEPTH &&
+        alpha > -SEARCH_MATE_BOUND && eval + Search_futility_margin[depth] <= alpha;
+
+    //Step 6: Moves
+    SearchPicker_t picker;
+    Search_picker_init(search, &picker, ply, hit ? &entry : NULL);
+
+    BoardMove_t move;
+    BoardMove_t best = {0};
+    __UINT16_TYPE__ searched = 0;
+    while(Search_pick(search, &picker, &move)) {
+        ui8 quiet = Search_is_quiet(board, move);
+        Board_make_move(board, move, &search->stack);
+        Board_tt_prefetch(tt, board->key);
+        ui8 gives_check = Board_in_check_p(board, CB_TURN_COLOR(board));
+
+        if(futile && searched > 0 && quiet && !gives_check) {
+            Board_unmake_move(board, &search->stack);
+            continue;
+        }
+
+        int score;
+        if(searched == 0) {
+            score = -Search_negamax(search, -beta, -alpha, depth - 1, ply + 1, 1);
+        }
+        else {
+            //Late quiet moves are searched shallower first, and again at full depth if they beat alpha
+            int reduction = 0;
+            if(!(shared->disabled & CB_PRUNE_LMR) && depth >= SEARCH_LMR_DEPTH && searched >= SEARCH_LMR_MOVES &&
+                quiet && !check && !gives_check) {
+                reduction = shared->reductions[depth][(searched < 64) ? searched : 63] - pv_node;
+                if(reduction > depth - 2)
+                    reduction = depth - 2;
+                if(reduction < 0)
+                    reduction = 0;
+            }
+
+            score = -Search_negamax(search, -alpha - 1, -alpha, depth - 1 - reduction, ply + 1, 1);
+            if(score > alpha && reduction)
+                score = -Search_negamax(search, -alpha - 1, -alpha, depth - 1, ply + 1, 1);
+            if(score > alpha && score < beta)
+                score = -Search_negamax(search, -beta, -alpha, depth - 1, ply + 1, 1);
+        }
+
+        Board_unmake_move(board, &search->stack);
+        if(__atomic_load_n(&shared->stop, __ATOMIC_RELAXED))
+            return 0;
+
+        if(searched++ == 0)
+            best = move;
+
+        if(score > alpha) {
+            alpha = score;
+            best = move;
+
+            //New best move, prepend it to the child's variation
+            search->pv[ply][ply] = move;
+            for(ui8 p = ply + 1; p < search->pv_length[ply + 1]; p++)
+                search->pv[ply][p] = search->pv[ply + 1][p];
+            search->pv_length[ply] = search->pv_length[ply + 1];
+
+            if(alpha >= beta) {
+                Search_cutoff(search, move, depth, ply);
+                break;
+            }
+        }
+    }
+
+    //Mate or stalemate, nearer mates score higher
+    if(!best.code)
+        return check ? -CB_SCORE_MATE + ply : 0;
+
+    //Mates are stored relative to this position
+    int stored = alpha;
+    if(stored > SEARCH_MATE_BOUND) stored += ply;
+    if(stored < -SEARCH_MATE_BOUND) stored -= ply;
+    Board_tt_store(tt, board->key, best, stored, depth,
+        (alpha >= beta) ? CB_BOUND_LOWER : ((alpha > alpha_start) ? CB_BOUND_EXACT : CB_BOUND_UPPER));
+
+    return alpha;
+}
+
+/** @fn static void Search_init(Search_t *search, SearchShared_t *shared, unsigned int id)
+ * @brief Prepares the state of one search thread
+ */
+static void Search_init(Search_t *search, SearchShared_t *shared, unsigned int id) {
+    search->shared = shared;
+    search->id = id;
+    Board_clone_p(&search->board, shared->root);
+    Board_nnue_attach(&search->board, &search->acc);
+    search->eval_hits = 0;
+    search->eval_misses = 0;
+    search->stack = (BoardUndoStack_t) CB_UNDO_STACK(search->records);
+    search->nodes = 0;
+    search->pv_length[0] = 0;
+    memset(search->killers, 0, sizeof(search->killers));
+    memset(search->history, 0, sizeof(search->history));
+    Board_pawn_table_init(&search->pawns, SEARCH_PAWN_TABLE_KB);
+}
+
+/** @fn static void *Search_helper(void *arg)
+ * @brief Helper thread of lazy SMP, deepens on its own and only contributes through the shared table. Odd helpers
+ * @brief run one ply ahead of the main thread so the threads don't all search the same tree
+ * @returns NULL
+ */
+static void *Search_helper(void *arg) {
+    Search_t *search = (Search_t*) arg;
+    SearchShared_t *shared = search->shared;
+
+    for(ui8 depth = 1 + (search->id & 1); depth <= shared->max_depth && !__atomic_load_n(&shared->stop, __ATOMIC_RELAXED); depth++)
+        Search_negamax(search, -CB_SCORE_INF, CB_SCORE_INF, depth, 0, 1);
+
+    return NULL;
+}
+
+/** @fn static void *Search_watchdog(void *arg)
+ * @brief Watchdog thread, sleeps until the hard deadline and stops the search, unless it is woken up because the search
+ * @brief ended first. Searching threads only ever read the stop flag, so the deadline holds however long a node takes
+ * @returns NULL
+ */
+static void *Search_watchdog(void *arg) {
+    SearchWatchdog_t *watchdog = (SearchWatchdog_t*) arg;
+    struct timespec until = {.tv_sec = watchdog->deadline / 1000, .tv_nsec = (watchdog->deadline % 1000) * 1000000};
+
+    pthread_mutex_lock(&watchdog->lock);
+    while(!watchdog->done) {
+        if(Board_time_now() >= watchdog->deadline) {
+            __atomic_store_n(watchdog->stop, 1, __ATOMIC_RELAXED);
+            break;
+        }
+        pthread_cond_timedwait(&watchdog->wake, &watchdog->lock, &until);
+    }
+    pthread_mutex_unlock(&watchdog->lock);
+
+    return NULL;
+}
+
+/** @fn static ui8 Search_watchdog_start(SearchWatchdog_t *watchdog, ui8 *stop, ui64 deadline)
+ * @brief Starts the watchdog thread, its waits are measured on the same monotonic clock as Board_time_now
+ * @param stop Flag to be set at the deadline
+ * @param deadline Board_time_now at which the search is stopped
+ * @returns 1 - running || 0 - no thread
+ */
+static ui8 Search_watchdog_start(SearchWatchdog_t *watchdog, ui8 *stop, ui64 deadline) {
+    pthread_condattr_t attr;
+
+    watchdog->stop = stop;
+    watchdog->deadline = deadline;
+    watchdog->done = 0;
+    pthread_mutex_init(&watchdog->lock, NULL);
+    pthread_condattr_init(&attr);
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+    pthread_cond_init(&watchdog->wake, &attr);
+    pthread_condattr_destroy(&attr);
+
+    if(pthread_create(&watchdog->thread, NULL, Search_watchdog, watchdog)) {
+        pthread_cond_destroy(&watchdog->wake);
+        pthread_mutex_destroy(&watchdog->lock);
+        return 0;
+    }
+    return 1;
+}
+
+/** @fn static void Search_watchdog_stop(SearchWatchdog_t *watchdog)
+ * @brief Wakes the watchdog up if the deadline isn't reached yet and waits for it to end
+ */
+static void Search_watchdog_stop(SearchWatchdog_t *watchdog) {
+    pthread_mutex_lock(&watchdog->lock);
+    watchdog->done = 1;
+    pthread_cond_signal(&watchdog->wake);
+    pthread_mutex_unlock(&watchdog->lock);
+
+    pthread_join(watchdog->thread, NULL);
+    pthread_cond_destroy(&watchdog->wake);
+    pthread_mutex_destroy(&watchdog->lock);
+}
+
+/***** FUNCTIONALITY *****/
+
+/** @fn ui8 Board_search(const Board_t *board, const BoardSearchLimits_t *limits, BoardSearchResult_t *result)
+ * @brief Iterative deepening alpha-beta search for the side in turn, a stopped iteration falls back to the last complete one.
+ * @brief With more than one thread, helpers search the same position and share their findings through the table (lazy SMP).
+ * @brief Iterations are started as long as the time budget allows (Board_time_iteration), a watchdog thread stops the
+ * @brief search at the hard budget. If that happens during the first iteration, its best root move so far is returned,
+ * @brief or the first legal one if not even one root move was searched
+ * @param board Position to be searched
+ * @param limits Depth, node and time budget, 0 means no limit for each, thread count and table
+ * @param result Best move, score, principal variation and statistics
+ * @returns 1 - found a move || 0 - no legal move
+ */
+ui8 Board_search(const Board_t *board, const BoardSearchLimits_t *limits, BoardSearchResult_t *result) {
+    static const BoardSearchLimits_t defaults = {.depth = 0, .nodes = 0, .threads = 1, .tt = NULL, .evals = NULL, .disabled = 0,
+        .time = 0, .increment = 0, .moves_to_go = 0, .deadline = 0, .info = NULL};
+    if(!limits)
+        limits = &defaults;
+
+    //Step 1: Clock first, everything below counts against the budget
+    BoardTimer_t timer;
+    SearchWatchdog_t watchdog;
+    ui8 guarded = 0;
+    Board_time_init(&timer, limits);
+
+    //Step 2: Shared state, a table just for this search if none is given
+    BoardTT_t own_tt = {0};
+    SearchShared_t shared = {
+        .root = board,
+        .tt = limits->tt,
+        .evals = limits->evals,
+        .nodes = 0,
+        .node_limit = limits->nodes,
+        .max_depth = (limits->depth > 0 && limits->depth < CB_MAX_PLY) ? limits->depth : CB_MAX_PLY - 1,
+        .disabled = limits->disabled,
+        .stop = 0
+    };
+
+    //Reductions grow with the logarithm of both the depth and the move number
+    for(ui8 d = 0; d < CB_MAX_PLY; d++)
+        for(ui8 m = 0; m < 64; m++)
+            shared.reductions[d][m] = (d && m) ? (ui8) (0.75 + log(d) * log(m) / 2.25) : 0;
+    if(!shared.tt) {
+        if(!Board_tt_init(&own_tt, 16))
+            return 0;
+        shared.tt = &own_tt;
+    }
+    Board_tt_new_search(shared.tt);
+
+    unsigned int threads = (limits->threads < 1) ? 1 : limits->threads;
+    if(threads > CB_MAX_THREADS)
+        threads = CB_MAX_THREADS;
+    Search_t *searches = (Search_t*) malloc(threads * sizeof(Search_t));
+    if(!searches) {
+        Board_tt_free(&own_tt);
+        return 0;
+    }
+
+    //Step 3: Helpers and watchdog
+    for(unsigned int t = 0; t < threads; t++)
+        Search_init(&searches[t], &shared, t);
+    for(unsigned int t = 1; t < threads; t++)
+        pthread_create(&searches[t].thread, NULL, Search_helper, &searches[t]);
+    if(timer.hard)
+        guarded = Search_watchdog_start(&watchdog, &shared.stop, timer.start + timer.hard);
+
+    //Step 4: Main thread, reports every completed iteration
+    Search_t *search = &searches[0];
+    result->depth = 0;
+    result->pv_length = 0;
+    result->score = 0;
+
+    for(ui8 depth = 1; depth <= shared.max_depth; depth++) {
+        int score = Search_negamax(search, -CB_SCORE_INF, CB_SCORE_INF, depth, 0, 1);
+        if(__atomic_load_n(&shared.stop, __ATOMIC_RELAXED) || !search->pv_length[0])
+            break;
+
+        result->depth = depth;
+        result->score = score;
+        result->pv_length = search->pv_length[0];
+        for(ui8 p = 0; p < result->pv_length; p++)
+            result->pv[p] = search->pv[0][p];
+        result->best = result->pv[0];
+        result->nodes = __atomic_load_n(&shared.nodes, __ATOMIC_RELAXED) + search->nodes;
+        result->time = Board_time_elapsed(&timer);
+
+        if(limits->info)
+            limits->info(board, result);
+
+        //Nothing left to find once a forced mate is seen
+        if(score > CB_SCORE_MATE - CB_MAX_PLY || score < -CB_SCORE_MATE + CB_MAX_PLY)
+            break;
+        if(!Board_time_iteration(&timer, result->best))
+            break;
+    }
+
+    //The deadline hit the first iteration, its root moves searched so far are better than none, and any legal move is
+    //better than no move at all
+    if(!result->depth && search->pv_length[0]) {
+        result->pv_length = search->pv_length[0];
+        for(ui8 p = 0; p < result->pv_length; p++)
+            result->pv[p] = search->pv[0][p];
+        result->best = result->pv[0];
+    }
+    else if(!result->depth) {
+        BoardMoveList_t list;
+        if(Board_generate_moves(board, &list)) {
+            result->best = result->pv[0] = list.moves[0];
+            result->pv_length = 1;
+        }
+    }
+
+    //Step 5: Stop and collect the helpers and the watchdog
+    __atomic_store_n(&shared.stop, 1, __ATOMIC_RELAXED);
+    if(guarded)
+        Search_watchdog_stop(&watchdog);
+    for(unsigned int t = 1; t < threads; t++)
+        pthread_join(searches[t].thread, NULL);
+
+    result->nodes = shared.nodes;
+    for(unsigned int t = 0; t < threads; t++) {
+        result->nodes += searches[t].nodes;
+        Board_pawn_table_free(&searches[t].pawns);
+        if(shared.evals) {
+            shared.evals->hits += searches[t].eval_hits;
+            shared.evals->misses += searches[t].eval_misses;
+        }
+    }
+
+    result->time = Board_time_elapsed(&timer);
+
+    free(searches);
+    Board_tt_free(&own_tt);
+    return result->pv_length != 0;
+}
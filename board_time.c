@@ -0,0 +1,136 @@
+/****************************************************
+ *  CHESS ENGINE by David Schoosleitner             *
+ * Date: 15.08.2022                                 *
+ * File: board_time.c                               *
+ ****************************************************
+ * Responsibilities:                                *
+ *  - monotonic millisecond clock                   *
+ *  - time budget of a search from the game clock   *
+ *  - iterative deepening stop decisions            *
+ *                                                  *
+ * Requires:                                        *
+ *  - ...                                           *
+ ****************************************************/
+
+/***** INCLUDES *****/
+#include "board.h"
+#include <time.h>
+
+/***** LOCAL CONSTANTS *****/
+#define TIME_OVERHEAD (20)                      /* Milliseconds of the clock kept back for passing the move on */
+#define TIME_DEADLINE_MARGIN (2)                /* Milliseconds before a hard deadline the search is stopped, to unwind and return */
+#define TIME_MOVES_LEFT (30)                    /* Moves the clock is assumed to last without moves to go */
+#define TIME_MOVES_LEFT_MAX (50)                /* Moves to go beyond are counted as this many */
+#define TIME_HARD_FACTOR (4)                    /* Hard budget in multiples of the soft one */
+#define TIME_STABILITY_MAX (4)                  /* Iterations with the same best move that still shorten the budget */
+#define TIME_GROWTH_MIN (2)                     /* Iteration time growth assumed at least, and before two iterations are measured */
+#define TIME_GROWTH_MAX (4)                     /* ... and at most, short iterations are measured too coarsely to trust more */
+
+/* Share of the soft budget used, in percent, by iterations the best move stayed the same for */
+static const int Time_stability_scale[TIME_STABILITY_MAX + 1] = {160, 120, 100, 80, 65};
+
+/***** FUNCTIONALITY *****/
+
+/** @fn ui64 Board_time_now(void)
+ * @brief Monotonic clock, unaffected by changes of the system time
+ * @returns Milliseconds since an arbitrary point
+ */
+ui64 Board_time_now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (ui64) ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+/** @fn void Board_time_init(BoardTimer_t *timer, const BoardSearchLimits_t *limits)
+ * @brief Starts the clock of a search and splits its time into budgets. The soft budget is the share of the remaining
+ * @brief clock for this move, iterations aren't started beyond it. The hard budget may only be used if the search
+ * @brief is unstable and is also capped by the hard deadline, the search is stopped once it runs out
+ * @param timer Timer to be started
+ * @param limits Clock, increment, moves to go and hard deadline, all 0 = no time limit
+ * @returns none
+ */
+void Board_time_init(BoardTimer_t *timer, const BoardSearchLimits_t *limits) {
+    //Step 1: Start
+    timer->start = Board_time_now();
+    timer->soft = 0;
+    timer->hard = 0;
+    timer->stable = 0;
+    timer->last_best = (BoardMove_t) {0};
+    timer->last_iteration = 0;
+    timer->iteration = 0;
+    timer->iteration_start = timer->start;
+
+    //Step 2: Clock, a share of what's left plus most of the increment, never more than half the clock unless it's the last move
+    if(limits->time) {
+        ui64 available = (limits->time > TIME_OVERHEAD) ? limits->time - TIME_OVERHEAD : 1;
+        ui64 moves = limits->moves_to_go ? limits->moves_to_go : TIME_MOVES_LEFT;
+        if(moves > TIME_MOVES_LEFT_MAX)
+            moves = TIME_MOVES_LEFT_MAX;
+
+        ui64 cap = (moves > 1) ? available / 2 : available;
+        timer->soft = available / moves + limits->increment * 3 / 4;
+        timer->hard = timer->soft * TIME_HARD_FACTOR;
+        if(timer->hard > cap) timer->hard = cap;
+        if(timer->soft > timer->hard) timer->soft = timer->hard;
+        if(!timer->hard) timer->soft = timer->hard = 1;
+    }
+
+    //Step 3: Hard deadline, the whole of it may be used
+    if(limits->deadline) {
+        ui64 hard = (limits->deadline > TIME_DEADLINE_MARGIN) ? limits->deadline - TIME_DEADLINE_MARGIN : 1;
+        if(!timer->hard || hard < timer->hard)
+            timer->hard = hard;
+        if(!timer->soft || timer->soft > timer->hard)
+            timer->soft = timer->hard;
+    }
+}
+
+/** @fn ui64 Board_time_elapsed(const BoardTimer_t *timer)
+ * @brief Time since the search started
+ * @returns Milliseconds
+ */
+ui64 Board_time_elapsed(const BoardTimer_t *timer) {
+    return Board_time_now() - timer->start;
+}
+
+/** @fn ui8 Board_time_iteration(BoardTimer_t *timer, BoardMove_t best)
+ * @brief Called after every completed iteration, decides if the next one is worth starting. Stops once the soft budget,
+ * @brief scaled by how long the best move stayed the same, is used up, or when the next iteration is expected to run
+ * @brief past the hard budget and would be cut off anyway
+ * @param timer Timer of the search
+ * @param best Best move of the completed iteration
+ * @returns 1 - start the next iteration || 0 - stop
+ */
+ui8 Board_time_iteration(BoardTimer_t *timer, BoardMove_t best) {
+    ui64 now = Board_time_now();
+    ui64 elapsed = now - timer->start;
+
+    //Step 1: Stability of the best move
+    if(timer->last_best.code && best.from_file == timer->last_best.from_file && best.from_rank == timer->last_best.from_rank &&
+        best.to_file == timer->last_best.to_file && best.to_rank == timer->last_best.to_rank && best.special == timer->last_best.special) {
+        if(timer->stable < TIME_STABILITY_MAX)
+            timer->stable++;
+    }
+    else
+        timer->stable = 0;
+    timer->last_best = best;
+
+    //Step 2: Iteration times, every iteration takes about as much longer than the last one as that one did than its predecessor
+    timer->last_iteration = timer->iteration;
+    timer->iteration = now - timer->iteration_start;
+    timer->iteration_start = now;
+
+    if(!timer->hard)
+        return 1;
+
+    //Step 3: Soft budget
+    if(elapsed * 100 >= timer->soft * Time_stability_scale[timer->stable])
+        return 0;
+
+    //Step 4: The next iteration can't finish in time
+    ui64 growth = (timer->last_iteration && timer->iteration > timer->last_iteration) ?
+        (timer->iteration + timer->last_iteration - 1) / timer->last_iteration : TIME_GROWTH_MIN;
+    if(growth < TIME_GROWTH_MIN) growth = TIME_GROWTH_MIN;
+    if(growth > TIME_GROWTH_MAX) growth = TIME_GROWTH_MAX;
+    return elapsed + timer->iteration * growth <= timer->hard;
+}
@@ -0,0 +1,182 @@
+/****************************************************
+ *  CHESS ENGINE by David Schoosleitner             *
+ * Date: 15.08.2022                                 *
+ * File: board_tt.c                                 *
+ ****************************************************
+ * Responsibilities:                                *
+ *  - transposition table shared by search threads  *
+ *  - bucketed replacement by depth and age         *
+ *                                                  *
+ * Requires:                                        *
+ *  - ...                                           *
+ ****************************************************/
+
+/***** INCLUDES *****/
+#include "board.h"
+#include <stdlib.h>
+#include <string.h>
+
+/*
+ * ENTRY DATA FORMATTING:
+ * bits  0-17 - move: from file, from rank, to file, to rank (3 each), special (2), code (4)
+ * bits 18-33 - score + 32768
+ * bits 34-41 - depth
+ * bits 42-43 - bound
+ * bits 44-49 - age, the table generation of the search that stored it
+ *
+ * The lock word holds key ^ data. Both words are written without locking, an entry torn by
+ * two threads writing at once no longer matches its key and reads as a miss.
+ */
+
+/***** LOCAL FUNCTIONALITY *****/
+
+/** @fn static ui64 TT_pack(BoardMove_t move, int score, ui8 depth, ui8 bound, ui8 age)
+ * @brief Packs an entry into one word
+ */
+static ui64 TT_pack(BoardMove_t move, int score, ui8 depth, ui8 bound, ui8 age) {
+    ui64 m = (ui64) (move.from_file & 7) | ((ui64) (move.from_rank & 7) << 3) | ((ui64) (move.to_file & 7) << 6) |
+        ((ui64) (move.to_rank & 7) << 9) | ((ui64) (move.special & 3) << 12) | ((ui64) (move.code & 15) << 14);
+
+    return m | ((ui64) (score + 32768) << 18) | ((ui64) (ui8) depth << 34) | ((ui64) (bound & 3) << 42) | ((ui64) (age & 63) << 44);
+}
+
+/** @fn static void TT_unpack(ui64 data, BoardTTData_t *out)
+ * @brief Unpacks an entry word
+ */
+static void TT_unpack(ui64 data, BoardTTData_t *out) {
+    out->move.from_file = data & 7;
+    out->move.from_rank = (data >> 3) & 7;
+    out->move.to_file = (data >> 6) & 7;
+    out->move.to_rank = (data >> 9) & 7;
+    out->move.special = (data >> 12) & 3;
+    out->move.code = (data >> 14) & 15;
+    out->score = (int) ((data >> 18) & 0xFFFF) - 32768;
+    out->depth = (data >> 34) & 0xFF;
+    out->bound = (data >> 42) & 3;
+}
+
+/** @fn static int TT_worth(ui64 data, ui8 generation)
+ * @brief Value of keeping an entry, deep entries of recent searches are worth the most
+ */
+static int TT_worth(ui64 data, ui8 generation) {
+    int depth = (data >> 34) & 0xFF;
+    int age = (generation - ((data >> 44) & 63)) & 63;
+    return depth - 8 * age;
+}
+
+/***** FUNCTIONALITY *****/
+
+/** @fn ui8 Board_tt_init(BoardTT_t *tt, __SIZE_TYPE__ megabytes)
+ * @brief Allocates an empty table, the bucket count is the largest power of two within the budget
+ * @param tt Table to be initialized
+ * @param megabytes Memory budget, at least 1
+ * @returns is successful: 1 | else: 0
+ */
+ui8 Board_tt_init(BoardTT_t *tt, __SIZE_TYPE__ megabytes) {
+    __SIZE_TYPE__ size = 1;
+    while(size * 2 * sizeof(BoardTTBucket_t) <= megabytes * 1024 * 1024)
+        size *= 2;
+
+    //Buckets are cache line aligned, one probe touches one line
+    tt->buckets = (BoardTTBucket_t*) aligned_alloc(sizeof(BoardTTBucket_t), size * sizeof(BoardTTBucket_t));
+    tt->size = tt->buckets ? size : 0;
+    tt->generation = 0;
+    if(tt->buckets)
+        Board_tt_clear(tt);
+    return tt->buckets != NULL;
+}
+
+/** @fn void Board_tt_free(BoardTT_t *tt)
+ * @brief Releases a table
+ * @param tt Table to be freed
+ * @returns none
+ */
+void Board_tt_free(BoardTT_t *tt) {
+    free(tt->buckets);
+    tt->buckets = NULL;
+    tt->size = 0;
+}
+
+/** @fn void Board_tt_clear(BoardTT_t *tt)
+ * @brief Forgets every entry, e.g. for a new game
+ * @param tt Table to be cleared
+ * @returns none
+ */
+void Board_tt_clear(BoardTT_t *tt) {
+    memset(tt->buckets, 0, tt->size * sizeof(BoardTTBucket_t));
+}
+
+/** @fn void Board_tt_new_search(BoardTT_t *tt)
+ * @brief Advances the table generation, entries of earlier searches age and get replaced first
+ * @param tt Table
+ * @returns none
+ */
+void Board_tt_new_search(BoardTT_t *tt) {
+    tt->generation = (tt->generation + 1) & 63;
+}
+
+/** @fn ui8 Board_tt_probe(const BoardTT_t *tt, ui64 key, BoardTTData_t *out)
+ * @brief Looks up a position in its bucket
+ * @param tt Table
+ * @param key Board_t.key of the position
+ * @param out Filled on a hit
+ * @returns 1 - hit || 0 - miss
+ */
+ui8 Board_tt_probe(const BoardTT_t *tt, ui64 key, BoardTTData_t *out) {
+    const BoardTTBucket_t *bucket = &tt->buckets[key & (tt->size - 1)];
+
+    for(ui8 i = 0; i < CB_TT_BUCKET; i++) {
+        ui64 lock = __atomic_load_n(&bucket->entries[i].lock, __ATOMIC_RELAXED);
+        ui64 data = __atomic_load_n(&bucket->entries[i].data, __ATOMIC_RELAXED);
+
+        if((lock ^ data) == key && data) {
+            TT_unpack(data, out);
+            return 1;
+        }
+    }
+    return 0;
+}
+
+/** @fn void Board_tt_store(BoardTT_t *tt, ui64 key, BoardMove_t move, int score, ui8 depth, ui8 bound)
+ * @brief Stores a search result over the same position, an empty entry, or the least worthy entry of the bucket
+ * @param tt Table
+ * @param key Board_t.key of the position
+ * @param move Best move, code 0 if none is known
+ * @param score Score, mates relative to this position
+ * @param depth Remaining depth it was searched with
+ * @param bound CB_BOUND_*
+ * @returns none
+ */
+void Board_tt_store(BoardTT_t *tt, ui64 key, BoardMove_t move, int score, ui8 depth, ui8 bound) {
+    BoardTTBucket_t *bucket = &tt->buckets[key & (tt->size - 1)];
+    BoardTTEntry_t *replace = &bucket->entries[0];
+    int worth = CB_SCORE_INF;
+
+    for(ui8 i = 0; i < CB_TT_BUCKET; i++) {
+        BoardTTEntry_t *entry = &bucket->entries[i];
+        ui64 lock = __atomic_load_n(&entry->lock, __ATOMIC_RELAXED);
+        ui64 data = __atomic_load_n(&entry->data, __ATOMIC_RELAXED);
+
+        //Same position, keep its move if this result has none
+        if((lock ^ data) == key && data) {
+            replace = entry;
+            if(!move.code && ((data >> 14) & 15)) {
+                BoardTTData_t old;
+                TT_unpack(data, &old);
+                move = old.move;
+            }
+            break;
+        }
+
+        //Empty, or less worthy than what was found so far
+        int w = data ? TT_worth(data, tt->generation) : -CB_SCORE_INF;
+        if(w < worth) {
+            worth = w;
+            replace = entry;
+        }
+    }
+
+    ui64 data = TT_pack(move, score, depth, bound, tt->generation);
+    __atomic_store_n(&replace->lock, key ^ data, __ATOMIC_RELAXED);
+    __atomic_store_n(&replace->data, data, __ATOMIC_RELAXED);
+}
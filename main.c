@@ -1,17 +1,21 @@
 #include "board.h"
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#include <time.h>
 
-void pout(Board_t b) {
+#define EVAL_CACHE_MB (8)
+
+void pout(const Board_t *b) {
     printf("\n**ABCDEFGH\n*\n");
     for(ui8 r = 7; r >= 0; r--) {
         printf("%i ", r+1);
         for(ui8 f = 0; f < 8; f++) {
             char oset = 0;
             char out;
-            if(Board_color_field(b, f, r) == 2)
+            if(Board_color_field_p(b, f, r) == 2)
                 oset = 'a'-'A';
-            switch(b.content[f][r] & ~(CB_BLACK_MASK | CB_WHITE_MASK)) {
+            switch(b->content[f][r] & ~(CB_BLACK_MASK | CB_WHITE_MASK)) {
                 case CB_EMPTY: out = '.'; break;
                 case CB_ROOK: out = 'R'+oset; break;
                 case CB_KNIGHT: out = 'N'+oset; break;
@@ -27,9 +31,50 @@ void pout(Board_t b) {
     printf("*\n**ABCDEFGH\n");
 }
 
-void pushlog(dynl_t *log, Board_t board) {
+int cmdis(const char *buf, const char *cmd) {
+    //Whole token, case insensitive
+    for(; *cmd; buf++, cmd++)
+        if(*buf != *cmd && *buf != *cmd - ('a'-'A'))
+            return 0;
+    return *buf == 0;
+}
+
+double seconds() {
+    struct timespec ts;
+    timespec_get(&ts, TIME_UTC);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+void perftout(ui64 nodes, double elapsed) {
+    printf("\nNodes: %llu\nTime: %.3f s\nNPS: %.0f\n", (unsigned long long) nodes, elapsed, (elapsed > 0) ? nodes / elapsed : 0.0);
+}
+
+void searchout(const Board_t *board, const BoardSearchResult_t *result) {
+    Board_t line;
+    BoardUndo_t records[CB_MAX_PLY];
+    BoardUndoStack_t stack = CB_UNDO_STACK(records);
+    char move[6];
+
+    if(result->score > CB_SCORE_MATE - CB_MAX_PLY)
+        printf("depth %u score mate %i nodes %llu time %llu pv", result->depth, (CB_SCORE_MATE - result->score + 1) / 2, (unsigned long long) result->nodes, (unsigned long long) result->time);
+    else if(result->score < -CB_SCORE_MATE + CB_MAX_PLY)
+        printf("depth %u score mate -%i nodes %llu time %llu pv", result->depth, (CB_SCORE_MATE + result->score) / 2, (unsigned long long) result->nodes, (unsigned long long) result->time);
+    else
+        printf("depth %u score cp %i nodes %llu time %llu pv", result->depth, result->score, (unsigned long long) result->nodes, (unsigned long long) result->time);
+
+    //Moves are written relative to the position they are played in
+    Board_clone_p(&line, board);
+    for(ui8 i = 0; i < result->pv_length; i++) {
+        Board_move_to_string(&line, result->pv[i], move);
+        printf(" %s", move);
+        Board_make_move(&line, result->pv[i], &stack);
+    }
+    printf("\n");
+}
+
+void pushlog(dynl_t *log, const Board_t *board) {
     Board_t *nb = (Board_t*) malloc(sizeof(Board_t));
-    Board_clone(nb, board);
+    Board_clone_p(nb, board);
 
     //iterator
     dynl_t *ilog = log;
@@ -77,7 +122,7 @@ void collapselog(dynl_t *log) {
 }
 
 void popfront(dynl_t *log, Board_t *board) {
-    Board_clone(board, *(log->b));
+    Board_clone_p(board, log->b);
     free(log->b);
     
     dynl_t *ilog = log;
@@ -90,14 +135,43 @@ void popfront(dynl_t *log, Board_t *board) {
     ilog->n = NULL;
 }
 
-int main() {
+int main(int argc, char **argv) {
     Board_t board;
     dynl_t *log;
     log = (dynl_t*) malloc(sizeof(dynl_t));
     log->n = NULL;
     log->b = NULL;
 
-    Board_init(&board);BoardMove_t m;pout(board);
+    Board_init(&board);BoardMove_t m;pout(&board);
+
+    //Search table, kept between searches, hash=mb on the command line sets its size
+    BoardTT_t tt;
+    unsigned int hash = 16;
+    for(int i = 1; i < argc; i++)
+        if(!strncmp(argv[i], "hash=", 5) && atoi(argv[i] + 5) > 0)
+            hash = atoi(argv[i] + 5);
+    if(!Board_tt_init(&tt, hash)) {
+        printf("\n -> Not enough memory for a %u MB table! \n\n", hash);
+        return 0;
+    }
+    unsigned int threads = 1;
+
+    //Evaluation cache, kept between searches like the table
+    BoardEvalCache_t evals;
+    if(!Board_eval_cache_init(&evals, EVAL_CACHE_MB)) {
+        printf("\n -> Not enough memory for the evaluation cache! \n\n");
+        return 0;
+    }
+
+    //Optional network, nnue=path on the command line
+    for(int i = 1; i < argc; i++) {
+        if(strncmp(argv[i], "nnue=", 5))
+            continue;
+        if(Board_nnue_load(argv[i] + 5))
+            printf("\n -> Network %s loaded \n\n", argv[i] + 5);
+        else
+            printf("\n -> Could not load network %s, using the classical evaluation \n\n", argv[i] + 5);
+    }
 
     ui8 ret;
 
@@ -126,13 +200,174 @@ int main() {
     - sa path - save board to path\n\
     - lo path - load board from path\n\
     - un - undo latest moves\n\
-    - edit (f)(r)(c)(p) - edit board customly (example: edit f5wp -> sets f5 to white queen, edit h1 -> sets h1 to empty)\n");
+    - edit (f)(r)(c)(p) - edit board customly (example: edit f5wp -> sets f5 to white queen, edit h1 -> sets h1 to empty)\n\
+    - fen (fen) - load board from FEN\n\
+    - perft (d) [threads=n] [hash=mb] - count leaf positions to depth d, optionally on n threads with a cache of mb megabytes\n\
+    - divide (d) - perft per move\n\
+    - perftcheck - run perft on the reference positions\n\
+    - go [depth n] [nodes n] [threads n] [time ms] [inc ms] [movestogo n] [deadline ms] [off nmp,lmr,futility,rfp] - search the best move, the thread count is kept for later searches, time, inc and movestogo describe the clock, deadline is a hard limit for this move, off switches pruning techniques off for this search\n");
+            continue;
+        }
+
+        // Perft
+        if(cmdis(buf, "perft")) {
+            unsigned int depth = 0;
+            unsigned int threads = 1;
+            char opts[bufmax] = {0};
+            if(scanf("%u", &depth) != 1) {
+                printf("Usage:\n- > perft 5\n- > perft 6 threads=8 hash=256");
+                continue;
+            }
+
+            //Optional threads=n and hash=mb on the same line
+            fgets(opts, bufmax, stdin);
+            char *t = strstr(opts, "threads=");
+            if(t) threads = atoi(t + 8);
+            if(threads < 1) threads = 1;
+            if(threads > 64) threads = 64;
+
+            BoardPerftCache_t cache = {0};
+            char *h = strstr(opts, "hash=");
+            if(h && atoi(h + 5) > 0 && !Board_perft_cache_init(&cache, atoi(h + 5))) {
+                printf("\n -> Not enough memory for the cache! \n\n");
+                continue;
+            }
+
+            double start = seconds();
+            ui64 nodes = Board_perft_cached(&board, depth, threads, cache.entries ? &cache : NULL);
+            perftout(nodes, seconds() - start);
+
+            if(cache.entries) {
+                ui64 lookups = cache.hits + cache.misses;
+                printf("Cache: %llu entries, %llu hits, %llu misses, %.1f%% hit rate\n", (unsigned long long) cache.size,
+                    (unsigned long long) cache.hits, (unsigned long long) cache.misses, lookups ? 100.0 * cache.hits / lookups : 0.0);
+                Board_perft_cache_free(&cache);
+            }
+            continue;
+        }
+
+        // Divide
+        if(cmdis(buf, "divide")) {
+            unsigned int depth = 0;
+            if(scanf("%u", &depth) != 1) {
+                printf("Usage:\n- > divide 5");
+                continue;
+            }
+
+            BoardMoveList_t list;
+            ui64 counts[CB_MAX_MOVES];
+            ui64 nodes = 0;
+            char move[6];
+
+            double start = seconds();
+            Board_perft_divide(&board, depth, &list, counts);
+            double elapsed = seconds() - start;
+
+            for(__UINT16_TYPE__ i = 0; i < list.count; i++) {
+                Board_move_to_string(&board, list.moves[i], move);
+                printf("%s: %llu\n", move, (unsigned long long) counts[i]);
+                nodes += counts[i];
+            }
+            printf("\nMoves: %u", list.count);
+            perftout(nodes, elapsed);
+            continue;
+        }
+
+        // Search
+        if(cmdis(buf, "go")) {
+            BoardSearchLimits_t limits = {.depth = 0, .nodes = 0, .threads = threads, .tt = &tt, .evals = &evals, .info = searchout};
+            BoardSearchResult_t result;
+            char opts[bufmax] = {0};
+
+            //Optional depth n, nodes n, threads n and the clock in milliseconds on the same line, depth 5 if no limit is given
+            fgets(opts, bufmax, stdin);
+            char *d = strstr(opts, "depth");
+            char *n = strstr(opts, "nodes");
+            char *t = strstr(opts, "threads");
+            char *c = strstr(opts, "time");
+            char *i = strstr(opts, "inc");
+            char *m = strstr(opts, "movestogo");
+            char *l = strstr(opts, "deadline");
+            if(d) limits.depth = (atoi(d + 5) < 1) ? 1 : ((atoi(d + 5) >= CB_MAX_PLY) ? CB_MAX_PLY - 1 : atoi(d + 5));
+            if(n) limits.nodes = strtoull(n + 5, NULL, 10);
+            if(t) threads = (atoi(t + 7) < 1) ? 1 : atoi(t + 7);
+            if(threads > CB_MAX_THREADS) threads = CB_MAX_THREADS;
+            limits.threads = threads;
+            if(c) limits.time = strtoull(c + 4, NULL, 10);
+            if(i) limits.increment = strtoull(i + 3, NULL, 10);
+            if(m) limits.moves_to_go = atoi(m + 9);
+            if(l) limits.deadline = strtoull(l + 8, NULL, 10);
+            if(!limits.depth && !limits.nodes && !limits.time && !limits.deadline) limits.depth = 5;
+
+            //off nmp,lmr,futility,rfp switches selective search techniques off for this search
+            char *o = strstr(opts, "off");
+            if(o) {
+                if(strstr(o, "nmp")) limits.disabled |= CB_PRUNE_NULL;
+                if(strstr(o, "lmr")) limits.disabled |= CB_PRUNE_LMR;
+                if(strstr(o, "futility")) limits.disabled |= CB_PRUNE_FUTILITY;
+                if(strstr(o, "rfp")) limits.disabled |= CB_PRUNE_REVERSE;
+            }
+
+            evals.hits = evals.misses = 0;
+            double start = seconds();
+            if(!Board_search(&board, &limits, &result)) {
+                printf("\n -> No move to search! \n\n");
+                continue;
+            }
+            double elapsed = seconds() - start;
+
+            char move[6];
+            Board_move_to_string(&board, result.best, move);
+            printf("bestmove %s\n", move);
+            perftout(result.nodes, elapsed);
+
+            ui64 lookups = evals.hits + evals.misses;
+            printf("Eval cache: %llu entries, %llu hits, %llu misses, %.1f%% hit rate\n", (unsigned long long) evals.size,
+                (unsigned long long) evals.hits, (unsigned long long) evals.misses, lookups ? 100.0 * evals.hits / lookups : 0.0);
+            continue;
+        }
+
+        // Perft reference positions
+        if(cmdis(buf, "perftcheck")) {
+            ui64 total = 0;
+            double start = seconds();
+            ui8 failed = 0;
+
+            for(ui8 i = 0; i < CB_PERFT_CASES; i++) {
+                Board_t test;
+                Board_load_from_fen(&test, Board_perft_cases[i].fen);
+                ui64 nodes = Board_perft(&test, Board_perft_cases[i].depth);
+                total += nodes;
+
+                ui8 ok = (nodes == Board_perft_cases[i].nodes);
+                if(!ok) failed++;
+                printf("%s %s depth %u: %llu (expected %llu)\n", ok ? "OK  " : "FAIL", Board_perft_cases[i].fen, Board_perft_cases[i].depth,
+                    (unsigned long long) nodes, (unsigned long long) Board_perft_cases[i].nodes);
+            }
+            perftout(total, seconds() - start);
+            printf(failed ? "\n -> %u positions FAILED\n" : "\n -> All positions passed\n", failed);
+            continue;
+        }
+
+        // Load FEN, rest of the line
+        if(cmdis(buf, "fen")) {
+            char fen[bufmax] = {0};
+            fgets(fen, bufmax, stdin);
+            char *f = fen;
+            while(*f == ' ') f++;
+
+            if(Board_load_from_fen(&board, f)) {
+                pout(&board);
+                collapselog(log);
+                continue;
+            }
+            printf("\n -> Error on loading FEN! \n\n");
             continue;
         }
 
         // Printout
         if(buf[0] == 'p' || buf[0] == 'P') {
-            pout(board);
+            pout(&board);
             continue;
         }
 
@@ -141,7 +376,7 @@ int main() {
            (buf[1] == 'e' || buf[1] == 'E') &&
            (buf[2] == 's' || buf[2] == 'S')
         ) {
-            Board_init(&board);pout(board);
+            Board_init(&board);pout(&board);
             collapselog(log);
             continue;
         }
@@ -155,7 +390,7 @@ int main() {
             Board_load_from_string(&board,
                 "CHEDS" "\5" "1.0.2" "\0\0\0\0\1"
             );
-            pout(board);
+            pout(&board);
             collapselog(log);
             continue;
         }
@@ -168,7 +403,7 @@ int main() {
             char path[260] = {0};
             fscanf(stdin, "%s", path);
 
-            if(Board_save_to_file(board, path)) {
+            if(Board_save_to_file_p(&board, path)) {
                 printf("\n -> Saved to %s! \n\n", path);
                 continue;
             }
@@ -186,7 +421,7 @@ int main() {
             
             if(Board_load_from_file(&board, path)) {
                 printf("\n -> Loaded from %s! \n\n", path);
-                pout(board);
+                pout(&board);
                 collapselog(log);
                 continue;
             }
@@ -220,9 +455,9 @@ int main() {
 
             //clear:
             if(edit[2] == 0 && edit[3] == 0) {
-                pushlog(log, board);
-                board.content[f][r] = CB_EMPTY;
-                pout(board);
+                pushlog(log, &board);
+                Board_set_field(&board, f, r, CB_EMPTY);
+                pout(&board);
                 continue;
             }
 
@@ -244,9 +479,9 @@ int main() {
             }
             if(!p) continue;
 
-            pushlog(log, board);
-            board.content[f][r] = p;
-            pout(board);
+            pushlog(log, &board);
+            Board_set_field(&board, f, r, p);
+            pout(&board);
             continue;
         }
 
@@ -261,7 +496,7 @@ int main() {
 
             printf("\nUndoing last step!\n");
             popfront(log, &board);
-            pout(board);
+            pout(&board);
             continue;
         }
 
@@ -278,20 +513,20 @@ int main() {
             continue;
         }
 
-        ret = Board_translate_expression(board, &m, buf);
+        ret = Board_translate_expression_p(&board, &m, buf);
         if(ret == 0 || ret == 3 || ret == 4) {
             printf("\n====================\nTranslation error: %u", ret);
             continue;
         }
 
         Board_t blg;
-        Board_clone(&blg, board);
+        Board_clone_p(&blg, &board);
         ret = Board_apply(&board, m);
         if(ret == 0 || ret == 3 || ret == 4) {
             printf("\n====================\nErr code: %u", ret);
             continue;
         }
-        pushlog(log, blg);
+        pushlog(log, &blg);
 
         
         if(ret == 125) {
@@ -302,11 +537,13 @@ int main() {
             printf("\n ==========\n=== DRAW ===\n ==========\n");
         }
 
-        pout(board);
+        pout(&board);
     }
 
     collapselog(log);
     free(log);
+    Board_tt_free(&tt);
+    Board_eval_cache_free(&evals);
 
     return 1;
 }
\ No newline at end of file